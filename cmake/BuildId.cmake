@@ -0,0 +1,19 @@
+# Writes BUILD_ID_OUTPUT, a source file defining vkgen::buildId() as a hash of all generator sources.
+# Caches that store generated text key on it, so a change in any translation unit invalidates them.
+# Invoked at build time: cmake -DBUILD_ID_SOURCES=<list> -DBUILD_ID_OUTPUT=<file> -P BuildId.cmake
+
+set(content "")
+foreach(src ${BUILD_ID_SOURCES})
+    file(READ ${src} data)
+    string(APPEND content "${src}\n${data}\n")
+endforeach()
+string(SHA256 hash "${content}")
+string(SUBSTRING ${hash} 0 16 hash)
+
+set(output "// generated by cmake/BuildId.cmake\n#include \"BuildId.hpp\"\n\nstd::string_view vkgen::buildId() {\n    return \"${hash}\";\n}\n")
+if(EXISTS ${BUILD_ID_OUTPUT})
+    file(READ ${BUILD_ID_OUTPUT} old)
+endif()
+if(NOT "${old}" STREQUAL "${output}")
+    file(WRITE ${BUILD_ID_OUTPUT} "${output}")
+endif()
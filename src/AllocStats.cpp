@@ -0,0 +1,196 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AllocStats.hpp"
+
+#ifdef GENERATOR_ALLOC_STATS
+
+#  include <cstdlib>
+#  include <new>
+
+namespace
+{
+    // plain thread local counters, no contention between generator threads
+    thread_local size_t allocCount = 0;
+    thread_local size_t allocBytes = 0;
+
+    template <typename F>
+    void *allocate(std::size_t size, F &&alloc) {
+        allocCount++;
+        allocBytes += size;
+        if (size == 0) {
+            size = 1;
+        }
+        while (true) {
+            if (void *p = alloc(size)) {
+                return p;
+            }
+            auto handler = std::get_new_handler();
+            if (!handler) {
+                throw std::bad_alloc{};
+            }
+            handler();
+        }
+    }
+
+    void *allocate(std::size_t size) {
+        return allocate(size, [](std::size_t size) { return std::malloc(size); });
+    }
+
+    void *allocate(std::size_t size, std::align_val_t align) {
+        const auto alignment = static_cast<std::size_t>(align);
+        return allocate(size, [&](std::size_t size) {
+#  ifdef _WIN32
+            return _aligned_malloc(size, alignment);
+#  else
+            // aligned_alloc needs size to be multiple of alignment
+            return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#  endif
+        });
+    }
+
+    void deallocate(void *p, std::align_val_t) noexcept {
+#  ifdef _WIN32
+        _aligned_free(p);
+#  else
+        std::free(p);
+#  endif
+    }
+}  // namespace
+
+namespace vkgen
+{
+
+    AllocStats::Counters AllocStats::current() {
+        return Counters{ allocCount, allocBytes };
+    }
+
+}  // namespace vkgen
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    return allocate(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return allocate(size, align);
+}
+
+void *operator new(std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size, align);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t &) noexcept {
+    try {
+        return allocate(size, align);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t align) noexcept {
+    deallocate(p, align);
+}
+
+void operator delete[](void *p, std::align_val_t align) noexcept {
+    deallocate(p, align);
+}
+
+void operator delete(void *p, std::size_t, std::align_val_t align) noexcept {
+    deallocate(p, align);
+}
+
+void operator delete[](void *p, std::size_t, std::align_val_t align) noexcept {
+    deallocate(p, align);
+}
+
+void operator delete(void *p, std::align_val_t align, const std::nothrow_t &) noexcept {
+    deallocate(p, align);
+}
+
+void operator delete[](void *p, std::align_val_t align, const std::nothrow_t &) noexcept {
+    deallocate(p, align);
+}
+
+#else
+
+namespace vkgen
+{
+
+    AllocStats::Counters AllocStats::current() {
+        return {};
+    }
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_ALLOC_STATS
@@ -0,0 +1,55 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_ALLOCSTATS_HPP
+#define GENERATOR_ALLOCSTATS_HPP
+
+#include <cstddef>
+
+namespace vkgen
+{
+
+    // Heap allocation counters of the calling thread, maintained by replaced global operator new.
+    // Only built with GENERATOR_ALLOC_STATS (cmake -DGENERATOR_ALLOC_STATS=ON), counters stay zero otherwise
+    class AllocStats
+    {
+      public:
+        struct Counters
+        {
+            size_t count = {};
+            size_t bytes = {};
+
+            Counters operator-(const Counters &rhs) const {
+                return Counters{ count - rhs.count, bytes - rhs.bytes };
+            }
+        };
+
+        static constexpr bool enabled() {
+#ifdef GENERATOR_ALLOC_STATS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static Counters current();
+    };
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_ALLOCSTATS_HPP
@@ -31,7 +31,8 @@ struct ArgOption
     std::string longName;
     bool                       requiredValue = false;  // if true parser loads value with next argument
     bool                       set           = false;  // set to true if argument exists
-    std::string                value         = {};
+    std::string                value         = {};  // last value
+    std::vector<std::string>   values        = {};  // every value, for options given multiple times
 
     ArgOption() = default;
     ArgOption(const std::string &shortName, const std::string &longName, bool required = false)
@@ -70,6 +71,7 @@ class ArgParser
                 {
                     if (o->requiredValue) {
                         o->value = getArg(++i);  // try to fetch next argument
+                        o->values.push_back(o->value);
                     }
                     o->set = true;
                 }
@@ -17,6 +17,7 @@
 // SOFTWARE.
 #include "Config.hpp"
 
+#include <chrono>
 #include <cmath>
 #include "Generator.hpp"
 
@@ -197,6 +198,20 @@ namespace vkgen
         }
     }
 
+    uint64_t Config::hashOptions() const {
+        tinyxml2::XMLDocument doc;
+        auto *root = doc.NewElement(name.c_str());
+        doc.InsertFirstChild(root);
+        saveConfigParam(root, reflect());
+        if (dbg.methodTags.isDirty()) {
+            saveConfigParam(root, dbg.methodTags);
+        }
+
+        tinyxml2::XMLPrinter printer;
+        doc.Print(&printer);
+        return hashFnv1a(printer.CStr());
+    }
+
     void Config::load(Generator &gen, const std::string &filename) {
         using namespace tinyxml2;
 
@@ -243,7 +258,7 @@ namespace vkgen
                 // std::cout << "tag: " << tag << '\n';
                 if (tag == parent->name) {
                     for (auto line : split2(value, "\n")) {
-                        std::string const t = regex_replace(std::string{ line }, std::regex("(^\\s*)|(\\s*$)"), "");
+                        std::string const t = strTrim(line);
                         if (!t.empty()) {
                             if (t == "*") {
                                 parent->all = true;
@@ -256,7 +271,7 @@ namespace vkgen
                 } else if (tag == "regex") {
                     // std::cout << "RGX: " << value << '\n';
                     try {
-                        parent->add(std::regex{ std::string{ value } });
+                        parent->addRegex(std::string{ value });
                     }
                     catch (const std::regex_error &err) {
                         std::cerr << "[Config load]: regex error: " << err.what() << '\n';
@@ -287,13 +302,14 @@ namespace vkgen
 
             // std::cout << "[Config load] whitelist built" << '\n';
 
+            std::vector<GenericType *> roots;
             for (const auto &b : bindings) {
-                b->prepare();
-            }
-
-            for (const auto &b : bindings) {
-                b->apply();
+                b->apply(roots);
             }
+            const std::unordered_set<GenericType *> requested{ roots.begin(), roots.end() };
+            const auto isRequested = [&](GenericType &type) {
+                return type.isSupported() && requested.contains(&type);
+            };
 
             gen.orderedCommands.clear();
             gen.orderedCommands.reserve(bCmds.ordered.size());
@@ -304,17 +320,18 @@ namespace vkgen
                 }
             }
 
+            // extensions and features are never pulled in as dependencies, so roots decide their state
             if (bExts.found) {
                 for (auto &e : gen.extensions) {
-                    if (e.isEnabled()) {
+                    if (isRequested(e)) {
                         for (auto &c : e.commands) {
-                            c.get().setEnabled(true);
+                            roots.push_back(&c.get());
                         }
                         for (auto &s : e.structs) {
-                            s.get().setEnabled(true);
+                            roots.push_back(&s.get());
                         }
                         for (auto &e : e.enums) {
-                            e.get().setEnabled(true);
+                            roots.push_back(&e.get());
                         }
                     }
                 }
@@ -323,23 +340,28 @@ namespace vkgen
             // if (!bCmds.found) {
                 for (auto &f : gen.features) {
                     // std::cout << "F: " << f.isEnabled() << "\n";
-                    if (f.isEnabled()) {
+                    if (isRequested(f)) {
                         for (auto &c : f.commands) {
-                            c.get().setEnabled(true);
+                            roots.push_back(&c.get());
                         }
                         for (auto &s : f.structs) {
-                            s.get().setEnabled(true);
+                            roots.push_back(&s.get());
                         }
                         for (auto &e : f.enums) {
-                            e.get().setEnabled(true);
+                            roots.push_back(&e.get());
                         }
                         for (auto &t : f.promotedTypes) {
-                            t.get().setEnabled(true);
+                            roots.push_back(&t.get());
                         }
                     }
                 }
             // }
 
+            const auto start = std::chrono::steady_clock::now();
+            gen.setEnabledBatch(roots);
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            std::cout << "[Config load] whitelist applied: " << roots.size() << " roots, " << elapsed.count() << "ms" << '\n';
+
             // std::cout << "[Config load] whitelist applied" << '\n';
         }
 
@@ -365,19 +387,21 @@ namespace vkgen
     }
 
     template <typename T>
-    void WhitelistBinding<T>::prepare() noexcept {
-        for (auto &e : *dst) {
-            e.setEnabled(false);
-        }
-    }
-
-    template <typename T>
-    void WhitelistBinding<T>::apply() noexcept {
+    void WhitelistBinding<T>::apply(std::vector<GenericType *> &roots) noexcept {
         if (all) {
             for (auto &e : *dst) {
-                e.setEnabled(true);
+                roots.push_back(&e);
             }
         }
+        const auto start = std::chrono::steady_clock::now();
+        const auto exact = filter.size();
+        size_t     count = 0;
+        try {
+            compile();
+        }
+        catch (const std::regex_error &err) {
+            std::cerr << "[Config load]: regex error: " << err.what() << " (" << name << ")" << '\n';
+        }
         for (auto &e : *dst) {
             bool match = false;
             auto it    = filter.find(e.name.original);
@@ -386,21 +410,23 @@ namespace vkgen
                 filter.erase(it);
             }
             if (!match) {
-                for (const auto &r : regexes) {
-                    if (std::regex_match(e.name.original, r)) {
-                        match = true;
-                        break;
-                    }
-                }
+                match = matches(e.name.original);
             }
             if (match) {
-                e.setEnabled(true);
+                roots.push_back(&e);
+                count++;
             }
             // std::cout << "enable: " << e.name << " " << e.typeString() << std::endl;
         }
         for (auto &f : filter) {
             std::cerr << "[Config load] Not found: " << f << " (" << name << ")" << '\n';
         }
+        if (found) {
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            std::cout << "[Config load] " << name << ": " << count << "/" << dst->size() << " matched, " << exact << " names, " << patterns.size()
+                      << " patterns (" << literals.size() + prefixes.size() << " without regex, " << separate.size() << " separate), " << elapsed.count()
+                      << "ms" << '\n';
+        }
     }
 
     template <>
@@ -150,6 +150,9 @@ namespace vkgen
         ConfigWrapper<bool>    branchHint{ "branch_hint", false };
         ConfigWrapper<bool>    importStdMacro{ "import_std_macro", false };
         ConfigWrapper<bool>    integrateVma{ "integrate_vma", false };
+        ConfigWrapper<bool>    dispatchLazy{ "dispatch_lazy", false };
+        ConfigWrapper<bool>    dispatchLoadExtensions{ "dispatch_load_extensions", false };
+        ConfigWrapper<bool>    dispatchHotLayout{ "dispatch_hot_layout", false };
         ConfigWrapper<bool>    proxyPassByCopy{ "proxy_pass_by_copy", false };
         ConfigWrapper<bool>    unifiedException{ "unified_exception", false };
 
@@ -173,6 +176,8 @@ namespace vkgen
 
         ConfigWrapper<std::string> contextClassName{ "context_class_name", { "Context" } };
         ConfigWrapper<std::string> moduleName{ "module_name", { "vulkan" } };
+        // space or comma separated commands placed first in DeviceDispatcher (dispatch_hot_layout)
+        ConfigWrapper<std::string> dispatchHotCommands{ "dispatch_hot_commands", { "" } };
 
         ConfigWrapper<int> classMethods{ "class_methods", { 1 } };
         ConfigWrapper<int> cppStd{ "cpp_standard", 20 };
@@ -205,6 +210,9 @@ namespace vkgen
                             branchHint,
                             importStdMacro,
                             integrateVma,
+                            dispatchLazy,
+                            dispatchLoadExtensions,
+                            dispatchHotLayout,
                             proxyPassByCopy,
                             unifiedException,
                             structReflect,
@@ -214,6 +222,7 @@ namespace vkgen
                             handleTemplates,
                             contextClassName,
                             moduleName,
+                            dispatchHotCommands,
                             classMethods,
                             raii,
                             structMock,
@@ -246,6 +255,9 @@ namespace vkgen
 
         void load(Generator &, const std::string &filename);
 
+        // hash of all saved options, whitelists excluded
+        uint64_t hashOptions() const;
+
         void reset() {
             macro = {};
             gen   = {};
@@ -315,7 +327,14 @@ namespace vkgen
         std::string                     name;
         std::vector<std::string>        ordered;
         std::unordered_set<std::string> filter;
-        std::vector<std::regex>         regexes;
+        std::vector<std::string>        patterns;
+        // compiled from patterns: plain names and "name.*" prefixes skip regex,
+        // the rest is combined into one alternation, except patterns with backreferences
+        // (group numbers would shift in the alternation) which are matched separately
+        std::unordered_set<std::string> literals;
+        std::vector<std::string>        prefixes;
+        std::optional<std::regex>       matcher;
+        std::vector<std::regex>         separate;
         bool found = false;
         bool all = false;
 
@@ -330,13 +349,75 @@ namespace vkgen
             return true;
         }
 
-        void add(const std::regex &rgx) {
-            regexes.emplace_back(rgx);
+        // throws std::regex_error if pattern is not valid
+        void addRegex(const std::string &pattern) {
+            std::regex{ pattern };
+            patterns.push_back(pattern);
+        }
+
+        static bool isLiteral(const std::string_view pattern) {
+            return pattern.find_first_of("\\^$.|?*+()[]{}") == std::string_view::npos;
+        }
+
+        // conservative, escaped backslash followed by digit is also treated as backreference
+        static bool hasBackreference(const std::string_view pattern) {
+            for (size_t i = 0; i + 1 < pattern.size(); ++i) {
+                if (pattern[i] == '\\' && ((pattern[i + 1] >= '1' && pattern[i + 1] <= '9') || pattern[i + 1] == 'k')) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void compile() {
+            literals.clear();
+            prefixes.clear();
+            separate.clear();
+            matcher.reset();
+
+            std::string combined;
+            for (const auto &p : patterns) {
+                const std::string_view view = p;
+                if (isLiteral(view)) {
+                    literals.insert(p);
+                } else if (view.ends_with(".*") && isLiteral(view.substr(0, view.size() - 2))) {
+                    prefixes.emplace_back(view.substr(0, view.size() - 2));
+                } else if (hasBackreference(view)) {
+                    separate.emplace_back(p, std::regex::ECMAScript | std::regex::optimize);
+                } else {
+                    if (!combined.empty()) {
+                        combined += '|';
+                    }
+                    combined += "(?:" + p + ")";
+                }
+            }
+            if (!combined.empty()) {
+                matcher.emplace(combined, std::regex::ECMAScript | std::regex::optimize);
+            }
         }
 
-        virtual void apply() = 0;
+        bool matches(const std::string &name) const {
+            if (literals.contains(name)) {
+                return true;
+            }
+            for (const auto &p : prefixes) {
+                if (name.starts_with(p)) {
+                    return true;
+                }
+            }
+            if (matcher && std::regex_match(name, *matcher)) {
+                return true;
+            }
+            for (const auto &r : separate) {
+                if (std::regex_match(name, r)) {
+                    return true;
+                }
+            }
+            return false;
+        }
 
-        virtual void prepare() = 0;
+        // collects matched types into roots, enabling is done by Registry::setEnabledBatch
+        virtual void apply(std::vector<GenericType *> &roots) = 0;
     };
 
     template <typename T>
@@ -348,9 +429,7 @@ namespace vkgen
             this->name = name;
         }
 
-        void apply() noexcept override;
-
-        void prepare() noexcept override;
+        void apply(std::vector<GenericType *> &roots) noexcept override;
     };
 
 }  // namespace vkgen
@@ -0,0 +1,154 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FileWatcher.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef __linux__
+#    include <poll.h>
+#    include <sys/inotify.h>
+#    include <unistd.h>
+#endif
+
+namespace vkgen
+{
+
+    std::filesystem::file_time_type FileWatcher::lastWriteTime(const std::filesystem::path &path) {
+        std::error_code ec;
+        const auto      time = std::filesystem::last_write_time(path, ec);
+        return ec ? std::filesystem::file_time_type{} : time;
+    }
+
+    void FileWatcher::collectPolled(std::vector<std::filesystem::path> &changed) {
+        for (auto &f : files) {
+            const auto time = lastWriteTime(f.path);
+            if (time != f.time) {
+                f.time = time;
+                if (std::find(changed.begin(), changed.end(), f.path) == changed.end()) {
+                    changed.push_back(f.path);
+                }
+            }
+        }
+    }
+
+#ifdef __linux__
+
+    FileWatcher::FileWatcher() {
+        fd = inotify_init1(IN_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("inotify_init1 failed: ") + std::strerror(errno));
+        }
+    }
+
+    FileWatcher::~FileWatcher() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    void FileWatcher::add(const std::filesystem::path &path) {
+        const auto file = std::filesystem::absolute(path).lexically_normal();
+        if (std::any_of(files.begin(), files.end(), [&](const Entry &e) { return e.path == file; })) {
+            return;
+        }
+        const auto dir = file.parent_path().string();
+        auto       it  = dirs.find(dir);
+        if (it == dirs.end()) {
+            const int wd = inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0) {
+                throw std::runtime_error("Can't watch " + dir + ": " + std::strerror(errno));
+            }
+            it = dirs.emplace(dir, wd).first;
+        }
+        files.push_back(Entry{ file, lastWriteTime(file), it->second });
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::wait() {
+        std::vector<std::filesystem::path> changed;
+        alignas(inotify_event) char        buffer[4096];
+
+        const auto readEvents = [&] {
+            const auto len = read(fd, buffer, sizeof(buffer));
+            if (len < 0) {
+                if (errno == EINTR) {
+                    return;
+                }
+                throw std::runtime_error(std::string("inotify read failed: ") + std::strerror(errno));
+            }
+            for (ssize_t i = 0; i < len;) {
+                const auto *event = reinterpret_cast<const inotify_event *>(buffer + i);
+                i += sizeof(inotify_event) + event->len;
+                if (event->len == 0) {
+                    continue;
+                }
+                const std::string_view name{ event->name };
+                for (const auto &f : files) {
+                    if (f.dir == event->wd && f.path.filename() == name &&
+                        std::find(changed.begin(), changed.end(), f.path) == changed.end()) {
+                        changed.push_back(f.path);
+                    }
+                }
+            }
+        };
+
+        while (changed.empty()) {
+            readEvents();
+        }
+        // drain follow-up events until the directory has been quiet for a while
+        pollfd pfd{ fd, POLLIN, 0 };
+        while (poll(&pfd, 1, static_cast<int>(settle.count())) > 0) {
+            readEvents();
+        }
+        return changed;
+    }
+
+#else
+
+    FileWatcher::FileWatcher() = default;
+
+    FileWatcher::~FileWatcher() = default;
+
+    void FileWatcher::add(const std::filesystem::path &path) {
+        const auto file = std::filesystem::absolute(path).lexically_normal();
+        if (std::any_of(files.begin(), files.end(), [&](const Entry &e) { return e.path == file; })) {
+            return;
+        }
+        files.push_back(Entry{ file, lastWriteTime(file) });
+    }
+
+    std::vector<std::filesystem::path> FileWatcher::wait() {
+        std::vector<std::filesystem::path> changed;
+        while (changed.empty()) {
+            std::this_thread::sleep_for(settle * 5);
+            collectPolled(changed);
+        }
+        // pick up files still being written by the same save
+        std::this_thread::sleep_for(settle);
+        collectPolled(changed);
+        return changed;
+    }
+
+#endif
+
+}  // namespace vkgen
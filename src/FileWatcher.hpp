@@ -0,0 +1,71 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_FILEWATCHER_HPP
+#define GENERATOR_FILEWATCHER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vkgen
+{
+
+    // Waits for modifications of a set of files. Parent directories are watched instead of the files
+    // themselves, so editors that save by writing a new file and renaming it over the old one are detected.
+    // Uses inotify on linux, elsewhere falls back to polling modification times.
+    class FileWatcher
+    {
+        struct Entry
+        {
+            std::filesystem::path           path;
+            std::filesystem::file_time_type time;
+            int                             dir = -1;
+        };
+
+        std::vector<Entry>                   files;
+        std::unordered_map<std::string, int> dirs;
+        int                                  fd = -1;
+
+        static std::filesystem::file_time_type lastWriteTime(const std::filesystem::path &path);
+
+        void collectPolled(std::vector<std::filesystem::path> &changed);
+
+      public:
+        // delay used to merge bursts of events (editor save, git checkout) into one change
+        std::chrono::milliseconds settle{ 100 };
+
+        FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+
+        FileWatcher &operator=(const FileWatcher &) = delete;
+
+        ~FileWatcher();
+
+        void add(const std::filesystem::path &path);
+
+        // blocks until at least one watched file changes, returns changed files
+        std::vector<std::filesystem::path> wait();
+    };
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_FILEWATCHER_HPP
@@ -25,6 +25,7 @@ namespace vkgen
 {
 
     using fmt::format;
+    using fmt::format_to;
 
 }  // namespace vkgen
 
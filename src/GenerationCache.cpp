@@ -0,0 +1,272 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GenerationCache.hpp"
+
+#include "Format.hpp"
+#include "SymbolTable.hpp"
+#include "Utils.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace vkgen
+{
+
+    std::string GenerationCache::directory;
+
+    template <typename T>
+    static bool readValue(std::string_view &src, T &dst) {
+        if (src.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&dst, src.data(), sizeof(T));
+        src.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    static bool readString(std::string_view &src, std::string_view &dst) {
+        uint32_t size = 0;
+        if (!readValue(src, size) || src.size() < size) {
+            return false;
+        }
+        dst = src.substr(0, size);
+        src.remove_prefix(size);
+        return true;
+    }
+
+    template <typename T>
+    static void writeValue(std::string &dst, const T &value) {
+        dst.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static void writeString(std::string &dst, std::string_view str) {
+        writeValue(dst, static_cast<uint32_t>(str.size()));
+        dst.append(str);
+    }
+
+    static void writeBuffer(std::string &dst, const OutputBuffer &src) {
+        std::vector<std::string_view> views;
+        src.gather(views);
+        writeValue(dst, static_cast<uint32_t>(src.size()));
+        const auto start = dst.size();
+        for (const auto &v : views) {
+            dst.append(v);
+        }
+        // size() does not count nested guards, patch the real length
+        const auto size = static_cast<uint32_t>(dst.size() - start);
+        std::memcpy(dst.data() + start - sizeof(uint32_t), &size, sizeof(uint32_t));
+    }
+
+    static bool readBuffer(std::string_view &src, OutputBuffer &dst) {
+        std::string_view text;
+        if (!readString(src, text)) {
+            return false;
+        }
+        dst.append(text);
+        return true;
+    }
+
+    void GenerationCache::serialize(std::string &dst, const GuardedOutput &src) {
+        auto &symbols = SymbolTable::global();
+        writeBuffer(dst, src.output);
+        writeValue(dst, static_cast<uint32_t>(src.segments.size()));
+        for (const auto &s : src.segments) {
+            writeValue(dst, s.parent);
+            writeString(dst, symbols[s.protect]);
+            writeValue(dst, static_cast<uint8_t>(s.ifdef));
+            writeBuffer(dst, s.output);
+        }
+    }
+
+    bool GenerationCache::deserialize(std::string_view &src, GuardedOutput &dst) {
+        uint32_t count = 0;
+        if (!readBuffer(src, dst.output) || !readValue(src, count)) {
+            return false;
+        }
+        // segment indices of stored block mapped to dst, parents are stored before children
+        std::vector<uint32_t> indices(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t         parent = 0;
+            std::string_view protect;
+            uint8_t          ifdef = 0;
+            if (!readValue(src, parent) || !readString(src, protect) || !readValue(src, ifdef)) {
+                return false;
+            }
+            if (parent != GuardedOutput::root && parent >= i) {
+                return false;
+            }
+            const auto id = SymbolTable::global().intern(protect);
+            indices[i]    = dst.segment(parent == GuardedOutput::root ? parent : indices[parent], id, ifdef != 0);
+            if (!readBuffer(src, dst.segments[indices[i]].output)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint64_t GenerationCache::hashFile(const std::filesystem::path &file) {
+        uint64_t hash = fnv1aBasis;
+
+        std::ifstream in(file, std::ios::binary);
+        std::array<char, 1 << 16> buffer;
+        while (in) {
+            in.read(buffer.data(), buffer.size());
+            hash = hashFnv1a({ buffer.data(), static_cast<size_t>(in.gcount()) }, hash);
+        }
+        return hash;
+    }
+
+    void GenerationCache::open(const std::filesystem::path &outputPath) {
+        close();
+        if (directory.empty()) {
+            return;
+        }
+        const auto key = hashFnv1a(std::filesystem::absolute(outputPath).string());
+        path    = std::filesystem::path{ directory } / vkgen::format("gen-{:016x}.cache", key);
+        enabled = true;
+
+        if (read()) {
+            std::cout << "generation cache: " << path.string() << " (" << entries.size() << " blocks)\n";
+        }
+    }
+
+    bool GenerationCache::read() {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) {
+            return false;
+        }
+        const auto size = static_cast<size_t>(in.tellg());
+        data.resize(size);
+        in.seekg(0);
+        in.read(data.data(), size);
+        if (!in) {
+            data.clear();
+            return false;
+        }
+
+        std::string_view src = data;
+        uint32_t fileMagic   = {};
+        uint32_t fileVersion = {};
+        uint64_t count       = {};
+        if (!readValue(src, fileMagic) || !readValue(src, fileVersion) || !readValue(src, count) || fileMagic != magic || fileVersion != version) {
+            std::cerr << "generation cache: ignoring outdated file " << path.string() << '\n';
+            data.clear();
+            return false;
+        }
+
+        entries.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint64_t         key = {};
+            std::string_view value;
+            if (!readValue(src, key) || !readString(src, value)) {
+                std::cerr << "generation cache: corrupted file " << path.string() << '\n';
+                entries.clear();
+                data.clear();
+                return false;
+            }
+            entries.emplace(key, value);
+        }
+        return true;
+    }
+
+    bool GenerationCache::find(uint64_t key, ItemOutput &out) {
+        if (!enabled) {
+            return false;
+        }
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            misses++;
+            return false;
+        }
+        std::string_view src = it->second;
+        ItemOutput       item;
+        if (!readBuffer(src, item.output) || !readBuffer(src, item.forward) || !deserialize(src, item.funcs.decl) || !deserialize(src, item.funcs.def) ||
+            !deserialize(src, item.funcs.templ) || !deserialize(src, item.funcs.platform)) {
+            misses++;
+            return false;
+        }
+        used.emplace(key, it->second);
+        out = std::move(item);
+        hits++;
+        return true;
+    }
+
+    void GenerationCache::insert(uint64_t key, const ItemOutput &item) {
+        if (!enabled) {
+            return;
+        }
+        std::string value;
+        writeBuffer(value, item.output);
+        writeBuffer(value, item.forward);
+        serialize(value, item.funcs.decl);
+        serialize(value, item.funcs.def);
+        serialize(value, item.funcs.templ);
+        serialize(value, item.funcs.platform);
+        used.insert_or_assign(key, std::move(value));
+    }
+
+    void GenerationCache::save() {
+        if (!enabled || used.empty()) {
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        auto tmp = path;
+        tmp += ".tmp";
+        {
+            std::string header;
+            writeValue(header, magic);
+            writeValue(header, version);
+            writeValue(header, static_cast<uint64_t>(used.size()));
+
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                std::cerr << "generation cache: can't write " << tmp.string() << '\n';
+                return;
+            }
+            out.write(header.data(), header.size());
+            for (const auto &e : used) {
+                std::string entry;
+                writeValue(entry, e.first);
+                writeString(entry, e.second);
+                out.write(entry.data(), entry.size());
+            }
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) {
+            std::cerr << "generation cache: can't write " << path.string() << ": " << ec.message() << '\n';
+            std::filesystem::remove(tmp, ec);
+        }
+    }
+
+    void GenerationCache::close() {
+        entries.clear();
+        used.clear();
+        data.clear();
+        path.clear();
+        hits    = {};
+        misses  = {};
+        enabled = false;
+    }
+
+}  // namespace vkgen
@@ -0,0 +1,87 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_GENERATIONCACHE_HPP
+#define GENERATOR_GENERATIONCACHE_HPP
+
+#include "Output.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace vkgen
+{
+
+    // Generated text of enum and struct blocks from the previous run, keyed by a hash of
+    // everything the block depends on. Only entries used by the current run are saved back,
+    // so the file does not grow with stale blocks.
+    class GenerationCache
+    {
+        static constexpr uint32_t magic   = 0x47474B56;  // "VKGG"
+        static constexpr uint32_t version = 2;
+
+        std::string                                    data;
+        std::unordered_map<uint64_t, std::string_view> entries;
+        std::unordered_map<uint64_t, std::string>      used;
+        std::filesystem::path                          path;
+        size_t                                         hits    = {};
+        size_t                                         misses  = {};
+        bool                                           enabled = {};
+
+        bool read();
+
+        static void serialize(std::string &dst, const GuardedOutput &src);
+
+        static bool deserialize(std::string_view &src, GuardedOutput &dst);
+
+      public:
+        static std::string directory;
+
+        static uint64_t hashFile(const std::filesystem::path &file);
+
+        // cache file for given output directory is placed in directory
+        void open(const std::filesystem::path &outputPath);
+
+        void save();
+
+        void close();
+
+        // restores cached block into out
+        bool find(uint64_t key, ItemOutput &out);
+
+        void insert(uint64_t key, const ItemOutput &item);
+
+        bool isEnabled() const {
+            return enabled;
+        }
+
+        size_t getHits() const {
+            return hits;
+        }
+
+        size_t getMisses() const {
+            return misses;
+        }
+    };
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_GENERATIONCACHE_HPP
@@ -17,8 +17,11 @@
 // SOFTWARE.
 
 #include "Generator.hpp"
+#include "BuildId.hpp"
 #include "Registry.hpp"
 #include "Format.hpp"
+#include "Parallel.hpp"
+#include "Trace.hpp"
 
 #include <filesystem>
 #include <iostream>
@@ -1889,6 +1892,81 @@ static constexpr char const *RES_OPTIONAL{ R"(
   };
 )" };
 
+static constexpr char const *RES_LAZY_PFN{ R"(
+  namespace detail {
+    template <typename Handle>
+    struct LazyResolver {
+      PFN_vkVoidFunction (VKAPI_PTR *getAddr)(Handle, const char *) = {};
+      Handle handle = {};
+    };
+
+    // PFN slot resolved on first call, names is a NUL separated list (command, then aliases)
+    // resolver is the offset of the owning dispatcher's LazyResolver relative to this slot,
+    // so only Owner may copy it (as part of a whole dispatcher)
+    template <typename PFN, typename Handle, typename Owner>
+    class LazyPFN;
+
+    template <typename R, typename... Args, typename Handle, typename Owner>
+    class LazyPFN<R (VKAPI_PTR *)(Args...), Handle, Owner> {
+      friend Owner;
+
+    public:
+      using Pointer = R (VKAPI_PTR *)(Args...);
+
+      constexpr LazyPFN(const char *names, std::ptrdiff_t resolver) noexcept : names(names), resolver(resolver) {}
+
+      R operator()(Args... args) const {
+        return get()(args...);
+      }
+
+      Pointer get() const {
+        Pointer f = pfn.load(std::memory_order_relaxed);
+        if (!f) {
+          f = resolve();
+        }
+        return f == &missing ? nullptr : f;
+      }
+
+      explicit operator bool() const {
+        return get() != nullptr;
+      }
+
+    private:
+      LazyPFN(const LazyPFN &rhs) noexcept : pfn(rhs.pfn.load(std::memory_order_relaxed)), names(rhs.names), resolver(rhs.resolver) {}
+
+      LazyPFN &operator=(const LazyPFN &rhs) noexcept {
+        pfn.store(rhs.pfn.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        names    = rhs.names;
+        resolver = rhs.resolver;
+        return *this;
+      }
+
+      // marks failed lookup, unsupported commands are not looked up again
+      static R VKAPI_CALL missing(Args...) {
+        return R();
+      }
+
+      Pointer resolve() const {
+        const auto &r = *reinterpret_cast<const LazyResolver<Handle> *>(reinterpret_cast<const char *>(this) + resolver);
+        Pointer     f = nullptr;
+        for (const char *n = names; !f && *n; n += std::strlen(n) + 1) {
+          f = reinterpret_cast<Pointer>(r.getAddr(r.handle, n));
+        }
+        if (!f) {
+          f = &missing;
+        }
+        // racing threads resolve the same address, relaxed order is enough
+        pfn.store(f, std::memory_order_relaxed);
+        return f;
+      }
+
+      mutable std::atomic<Pointer> pfn = {};
+      const char                  *names;
+      std::ptrdiff_t               resolver;
+    };
+  }  // namespace detail
+)" };
+
 static constexpr char const *RES_RAII{ R"(
     template <class T, class U = T>
     VULKAN_HPP_CONSTEXPR_14 VULKAN_HPP_INLINE T exchange( T & obj, U && newValue ) {
@@ -1983,6 +2061,68 @@ namespace vkgen
         // }
     }
 
+    static uint64_t hashValue(uint64_t value, uint64_t hash) {
+        return hashFnv1a({ reinterpret_cast<const char *>(&value), sizeof(value) }, hash);
+    }
+
+    static uint64_t hashTypeState(const GenericType &type, uint64_t hash) {
+        hash = hashFnv1a(type.name.original, hash);
+        hash = hashFnv1a(type.getProtect(), hash);
+        return hashValue(type.canGenerate(), hash);
+    }
+
+    uint64_t Generator::itemCacheKey(const Enum &data) const {
+        uint64_t hash = hashFnv1a("enum", genCacheKey);
+        hash          = hashTypeState(data, hash);
+        for (const auto &m : data.members) {
+            hash = hashTypeState(m, hash);
+        }
+        return hash;
+    }
+
+    uint64_t Generator::itemCacheKey(const Struct &data) const {
+        return hashTypeState(data, hashFnv1a("struct", genCacheKey));
+    }
+
+    template <typename T>
+    std::vector<ItemOutput> Generator::generateItems(const std::vector<const T *> &items, const std::function<void(const T &, ItemOutput &)> &func) {
+        std::vector<ItemOutput> outputs(items.size());
+        std::vector<uint64_t>   keys(items.size());
+        std::vector<size_t>     pending;
+        // handle classes depend on commands of other handles, they are not cached
+        constexpr bool cached = !std::is_same_v<T, Handle>;
+        for (size_t i = 0; i < items.size(); ++i) {
+            if constexpr (cached) {
+                if (genCache.isEnabled()) {
+                    keys[i] = itemCacheKey(*items[i]);
+                    if (genCache.find(keys[i], outputs[i])) {
+                        continue;
+                    }
+                }
+            }
+            pending.push_back(i);
+        }
+
+        parallelFor(pending.size(), jobs, [&](size_t i) { func(*items[pending[i]], outputs[pending[i]]); });
+
+        if constexpr (cached) {
+            for (const size_t i : pending) {
+                genCache.insert(keys[i], outputs[i]);
+            }
+        }
+
+        if (verifyJobs) {
+            for (size_t i = 0; i < items.size(); ++i) {
+                ItemOutput serial;
+                func(*items[i], serial);
+                if (serial.toString() != outputs[i].toString()) {
+                    throw std::runtime_error("output differs from serial generation: " + items[i]->name.original);
+                }
+            }
+        }
+        return outputs;
+    }
+
     //    std::string Generator::genPlatform(const GenericType &type, std::function<void(std::string &)> function, bool bypass) {
     //        const auto &p = type.getProtect();
     //        if (!p.empty()) {
@@ -3325,7 +3465,7 @@ import std;
                 std::string name = e.name;
                 auto        tag  = strRemoveTag(name);
                 if (name.ends_with("FlagBits")) {
-                    name = std::regex_replace(e.name, std::regex("FlagBits"), "Flags");
+                    name = toFlagsName(e.name);
                     output += std::move("  using " + m_ns + "::" + name + ";\n");
                 }
             }
@@ -3430,7 +3570,7 @@ import std;
             genOptional(module_output, *base, [&](auto &output) {
                 std::string name = e.name.original;
                 if (e.members.empty()) {
-                    name = std::regex_replace(name, std::regex("FlagBits"), "Flags");
+                    name = toFlagsName(name);
                 }
                 output += "  using ::" + name + ";";
                 // output += " // " + std::to_string(e.isSuppored()) + " " + e.name.original;
@@ -4101,6 +4241,7 @@ import std;
     }
 
     void Generator::generateApiVideo(std::filesystem::path path) {
+        Trace::Scope trace{ "generateApiVideo" };
         if (!video) {
             return;
         }
@@ -4118,6 +4259,7 @@ import std;
     }
 
     void Generator::generateApiC(std::filesystem::path path) {
+        Trace::Scope trace{ "generateApiC" };
         GenOutput vkfiles{ "vk", ".h", path };
         vkfiles.cguard = true;
         auto &platform = vkfiles.addFile("_platform");
@@ -4135,7 +4277,8 @@ import std;
         files.writeFiles(*this);
     }
 
-    void Generator::generateApiCpp(std::filesystem::path path) {
+    void Generator::generateApiCpp(std::filesystem::path path, std::future<void> *readers) {
+        Trace::Scope trace{ "generateApiCpp" };
         // std::cout << "gen files " << '\n';
 
         GenOutput out{ "vulkan", ".hpp", path };
@@ -4184,6 +4327,10 @@ import std;
             types += "#include \"vulkan_structs.hpp\"\n";
         }
 
+        if (readers) {
+            readers->get();
+        }
+
         generateHandles(handles, smart_handles, out);
 
         generateStructs(structs);
@@ -4286,7 +4433,7 @@ import std;
                             } else if (m->isStruct()) {
                                 output += "to_string(value." + m->identifier() + ")";
                             } else if (m->isEnum()) {
-                                std::string type = std::regex_replace(m->original.type(), std::regex("FlagBits"), "Flags");
+                                std::string type = toFlagsName(m->original.type());
                                 output += "string_" + type + "(value." + m->identifier() + ")";
                             } else {
                                 output += "std::to_string(value." + m->identifier() + ")";
@@ -4519,7 +4666,7 @@ import std;
         out.writeFiles(*this);
     }
 
-    void Generator::generateEnumStr(const Enum &data, OutputBuffer &output) {
+    void Generator::generateEnumStr(const Enum &data, OutputBuffer &output, GuardedOutputFuncs &toString) {
         const auto &name = data.isBitmask() ? data.bitmask : data.name;
 
         GuardedOutput                   members;
@@ -4569,7 +4716,7 @@ import std;
 
         if (cfg.gen.enumMock == 1 && data.isBitmask()) {
             output += "  namespace " + name + " {\n";
-            output += members.toString();
+            output += std::move(members);
             output += "  }\n";
         } else {
             output += "  enum class " + name;
@@ -4577,7 +4724,7 @@ import std;
                 output += " : " + data.name.original;
             }
             output += " {\n";
-            output += members.toString();
+            output += std::move(members);
             if (cfg.gen.enumMock == 2 && data.isBitmask()) {
                 output += "    allFlags = ";
                 output += std::move(generateAllFlagsValue(data));
@@ -4630,14 +4777,14 @@ import std;
 
         // to_string_output += fun.generate(outputFuncs);
         if (cfg.gen.globalMode) {
-            outputToStringDecl.add(data, [&](auto &output) {
+            toString.decl.add(data, [&](auto &output) {
                 output += "  ";
                 output += proto;
                 output += ";\n\n";
             });
         }
 
-        outputToStringDef.add(data, [&](auto &output) {
+        toString.def.add(data, [&](auto &output) {
             output += "  ";
             output += cfg.macro.mInline.define;
             output += " ";
@@ -4648,15 +4795,15 @@ import std;
         });
     }
 
-    void Generator::generateEnum(const Enum &data, OutputBuffer &output, OutputBuffer &output_forward) {
+    void Generator::generateEnum(const Enum &data, ItemOutput &out) {
         auto p = data.getProtect();
         //        if (!p.empty()) {
         //            outputFuncs.platform.add(data, [&](auto &output) { generateEnumStr(data, output); });
         //        } else {
-        genOptional(output, data, [&](auto &output) { generateEnumStr(data, output); });
+        genOptional(out.output, data, [&](auto &output) { generateEnumStr(data, output, out.funcs); });
         // }
 
-        genOptional(output_forward, data, [&](auto &output) {
+        genOptional(out.forward, data, [&](auto &output) {
             output += "  enum class " + data.name;
             if (data.isBitmask()) {
                 output += " : " + data.name.original;
@@ -4715,14 +4862,23 @@ import std;
         }
 
         std::unordered_set<std::string> generated;
+        std::vector<const Enum *>       items;
         for (const auto &e : enums) {
             if (generated.contains(e.name)) {
                 continue;
             }
-            generateEnum(e, output, output_forward);
+            items.push_back(&e);
             generated.insert(e.name);
         }
 
+        // to_string declarations and definitions are collected in funcs.decl and funcs.def
+        for (auto &item : generateItems<Enum>(items, [&](const Enum &e, ItemOutput &out) { generateEnum(e, out); })) {
+            output += std::move(item.output);
+            output_forward += std::move(item.forward);
+            outputToStringDecl.merge(std::move(item.funcs.decl));
+            outputToStringDef.merge(std::move(item.funcs.def));
+        }
+
         outputToStringDecl += endNamespace();
         outputToStringDef += endNamespace();
         output += endNamespace();
@@ -4757,7 +4913,7 @@ import std;
         if (values.empty()) {
             output += cfg.gen.enumMock < 2 ? "{}" : "0";
         } else {
-            std::string name = std::regex_replace(data.name, std::regex("FlagBits"), "Flags");
+            std::string name = toFlagsName(data.name);
             if (cfg.gen.enumMock < 2) {
                 output += "static_cast<";
                 output += name;
@@ -4799,7 +4955,7 @@ import std;
     }
 
     void Generator::genFlagTraits(const Enum &data, std::string inherit, OutputBuffer &output, std::string &to_string_code) {
-        std::string name = std::regex_replace(data.name, std::regex("FlagBits"), "Flags");
+        std::string name = toFlagsName(data.name);
 
         OutputBuffer str;
 
@@ -5602,22 +5758,28 @@ VULKAN_HPP_INLINE typename ResultValueType<void>::type createResultValueType( Vk
                 MemberGenerator g{ *this, d, decl, outputFuncs, true };
                 g.generate();
             }
-            std::stringstream str;
-            decl.write(str);
-            output += std::move(str.str());
+            output += std::move(decl);
         }
 
-        for (Handle &h : handles.ordered) {
+        std::vector<const Handle *> items;
+        for (const Handle &h : handles.ordered) {
             if (cfg.gen.onlyC && h.isSubclass) {
                 continue;
             }
-            // std::cout << "gen class " << e.name << '\n';
+            items.push_back(&h);
+        }
+        // std::cout << "gen class " << e.name << '\n';
+        const auto generateItem = [&](const Handle &h, ItemOutput &out) {
             // if (!cfg.gen.globalMode && cfg.gen.expApi && !h.isSubclass) {
             if ((cfg.gen.globalMode || cfg.gen.expApi) && !h.isSubclass) {
-                generateClassWithPFN(output, h);
+                generateClassWithPFN(out.output, const_cast<Handle &>(h), out.funcs);
             } else {
-                genPlatform(output, h, [&](auto &output) { generateClass(output, h, false); });
+                genPlatform(out.output, h, [&](auto &output) { generateClass(output, h, out.funcs, false); });
             }
+        };
+        for (auto &item : generateItems<Handle>(items, generateItem)) {
+            output += std::move(item.output);
+            outputFuncs.merge(std::move(item.funcs));
         }
 
         // if (!cfg.gen.cppModules) {
@@ -5776,8 +5938,24 @@ VULKAN_HPP_INLINE typename ResultValueType<void>::type createResultValueType( Vk
             }
         }
         output += beginNamespace();
+        std::vector<const Struct *> items;
         for (const Struct &e : structs.ordered) {
-            genPlatform(output, e, [&](auto &output) { generateStruct(output, e, exp); });
+            // done outside generateStruct, blocks restored from generation cache skip it
+            if (!cfg.gen.globalMode && e.canGenerate()) {
+                for (const auto &m : e.members) {
+                    if (m->hasArrayLength()) {
+                        m->setSpecialType(VariableData::TYPE_ARRAY);
+                    }
+                }
+            }
+            items.push_back(&e);
+        }
+        const auto generateItem = [&](const Struct &e, ItemOutput &out) {
+            genPlatform(out.output, e, [&](auto &output) { generateStruct(output, e, exp, out.funcs); });
+        };
+        for (auto &item : generateItems<Struct>(items, generateItem)) {
+            output += std::move(item.output);
+            outputFuncs.merge(std::move(item.funcs));
         }
 
         //        if (cfg.gen.globalMode) {
@@ -6175,11 +6353,11 @@ namespace std {
             });
         }
         output += "#ifndef VULKAN_HPP_NO_STRUCT_EXTENDS\n";
-        output += out.toString();
+        output += std::move(out);
         output += "#endif // VULKAN_HPP_NO_STRUCT_EXTENDS\n";
     }
 
-    bool Generator::generateStructConstructor(OutputBuffer &output, const Struct &data, bool transform) {
+    bool Generator::generateStructConstructor(OutputBuffer &output, const Struct &data, bool transform, GuardedOutputFuncs &funcs) {
         bool hasProxy = false;
 
         FunctionGenerator fun(*this, "", data.name);
@@ -6258,12 +6436,12 @@ namespace std {
             fun.add(pNext->fullType(*this), pNext->identifier() + "_", " = nullptr");
         }
 
-        output += fun.generate(outputFuncs);
+        output += fun.generate(funcs);
 
         return hasProxy;
     }
 
-    void Generator::generateStruct(OutputBuffer &output, const Struct &data, bool exp) {
+    void Generator::generateStruct(OutputBuffer &output, const Struct &data, bool exp, GuardedOutputFuncs &funcs) {
         bool genSetters          = data.hasStructType() && !data.returnedonly;
         bool genSettersProxy     = genSetters;
         bool genCompareOperators = data.isStruct();
@@ -6297,9 +6475,6 @@ namespace std {
                         }
                     }
                 }
-                if (m->hasArrayLength()) {
-                    m->setSpecialType(VariableData::TYPE_ARRAY);
-                }
             }
         }
 
@@ -6324,11 +6499,11 @@ namespace std {
         if (genConstructors) {
             if (data.isStruct()) {
                 gen(output, cfg.gen.structConstructors, [&](auto &output) {
-                    bool const hasProxy = generateStructConstructor(output, data, false);
+                    bool const hasProxy = generateStructConstructor(output, data, false, funcs);
 
                     if (hasProxy) {
                         output += "#  if !defined( VULKAN_HPP_DISABLE_ENHANCED_MODE )\n";
-                        generateStructConstructor(output, data, true);
+                        generateStructConstructor(output, data, true, funcs);
                         output += "#  endif // VULKAN_HPP_DISABLE_ENHANCED_MODE \n";
                     }
 
@@ -6353,7 +6528,7 @@ namespace std {
                         fun.specifierNoexcept = true;
                         fun.add("Vk" + data.name + " const &", "rhs");
                         fun.addInit(data.name, "*reinterpret_cast<" + data.name + " const *>( &rhs )");
-                        output += fun.generate(outputFuncs);
+                        output += fun.generate(funcs);
                     }
                 });
             } else {
@@ -6437,7 +6612,7 @@ namespace std {
 )",
                                                  id);
 
-                        output += fun.generate(outputFuncs);
+                        output += fun.generate(funcs);
                     }
                 }
 
@@ -6487,7 +6662,7 @@ namespace std {
                                                      m->identifier(),
                                                      modif);
 
-                            output += fun.generate(outputFuncs);
+                            output += fun.generate(funcs);
                         }
                     }
                 }
@@ -6563,7 +6738,7 @@ namespace std {
                 fun.specifierConst    = true;
                 fun.code              = "      return std::tie(" + tie.string() + ");\n";
 
-                output += fun.generate(outputFuncs);
+                output += fun.generate(funcs);
             });
         }
         if (cfg.gen.structMock > 0) {
@@ -6685,7 +6860,7 @@ namespace std {
                                                  ordering);
 
                         fun.add(data.name + " const &", "rhs");
-                        output += fun.generate(outputFuncs);
+                        output += fun.generate(funcs);
                     } else {
                         output += spaceshipOperator + "\n";
                     }
@@ -6703,7 +6878,7 @@ namespace std {
 
                     fun.add(data.name + " const &", "rhs");
                     fun.code = compareBody;
-                    output += fun.generate(outputFuncs);
+                    output += fun.generate(funcs);
                 }
                 {
                     FunctionGenerator fun(*this, "bool", "operator!=");
@@ -6715,7 +6890,7 @@ namespace std {
 
                     fun.add(data.name + " const &", "rhs");
                     fun.code = "      return !operator==( rhs );\n";
-                    output += fun.generate(outputFuncs);
+                    output += fun.generate(funcs);
                 }
 
                 if (!spaceshipOperator.empty()) {
@@ -6828,7 +7003,7 @@ namespace std {
         }
     }
 
-    void Generator::generateClassWithPFN(OutputBuffer &output, Handle &h) {
+    void Generator::generateClassWithPFN(OutputBuffer &output, Handle &h, GuardedOutputFuncs &funcs) {
         OutputClass out {
             .name = h.name
         };
@@ -6844,7 +7019,7 @@ namespace std {
         output += "    " + dispatch + " m_dispatcher = {};\n";
         output += "  public:\n";
 
-        output += out.sPublic.toString();
+        output += std::move(out.sPublic);
         output += "    explicit " + name + "(std::nullptr_t) VULKAN_HPP_NOEXCEPT {}\n";
 
         GuardedOutput ctors;
@@ -6865,13 +7040,13 @@ namespace std {
                           << '\n';
                 continue;
             }
-            resolver.generate(ctors, outputFuncs);
+            resolver.generate(ctors, funcs);
 
             MemberResolverInit init{ *this, d, ctx };
-            init.generate(ctors, outputFuncs);
+            init.generate(ctors, funcs);
         }
 
-        generateDestroyMember(h, dtor, outputFuncs);
+        generateDestroyMember(h, dtor, funcs);
 
         /*
         const bool indirect = cfg.gen.classMethods & 2;
@@ -6883,11 +7058,7 @@ namespace std {
             g.generate();
         }
         */
-        {
-            std::stringstream temp;
-            ctors.write(temp);  // TODO
-            output += temp.str();
-        }
+        output += std::move(ctors);
 
         output += "    " + name + "() = default;\n";
         output += "    " + name + "(" + name + " const&) = delete;\n";
@@ -6908,11 +7079,7 @@ namespace std {
         output += "      return *this;\n";
         output += "    }\n";
 
-        {
-            std::stringstream temp;
-            dtor.write(temp);
-            output += temp.str();
-        }
+        output += std::move(dtor);
 
         output += "    operator Vk" + name + "() const {\n";
         output += "      return " + handle + ";\n";
@@ -6990,8 +7157,17 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 #  endif
 #endif
 )";
+        if (cfg.gen.dispatchLazy) {
+            output += "#include <atomic>\n#include <cstddef>  // offsetof\n#include <cstring>  // std::strlen\n";
+        }
+        if (cfg.gen.dispatchLoadExtensions && !cfg.gen.dispatchLazy) {
+            output += "#include <algorithm>\n#include <iterator>\n#include <string_view>\n";
+        }
 
         output += beginNamespace();
+        if (cfg.gen.dispatchLazy) {
+            output += RES_LAZY_PFN;
+        }
         generateDispatchRAII(output);
         generateLoader(output, true);
         output += endNamespace();
@@ -7158,6 +7334,43 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         OutputBuffer      init;
         OutputBuffer      init2;
         bool             isContext;
+        bool             useLazy  = {};
+
+        // DeviceDispatcher hot layout: configured hot commands, then command buffer recording commands,
+        // then the rest, each part in registry order
+        std::vector<ClassCommand *> orderedMembers() const {
+            std::vector<ClassCommand *> members = h.filteredMembers;
+            const auto                 &cfg     = gen.getConfig().gen;
+            if (h.name != "Device" || !cfg.dispatchHotLayout) {
+                return members;
+            }
+
+            std::unordered_map<std::string_view, size_t> hot;
+            const std::string_view                       list = cfg.dispatchHotCommands.data;
+            for (size_t pos = 0; pos < list.size();) {
+                const auto end = std::min(list.find_first_of(" ,\t\n", pos), list.size());
+                if (end > pos) {
+                    hot.emplace(list.substr(pos, end - pos), hot.size());
+                }
+                pos = end + 1;
+            }
+
+            const auto rank = [&](const ClassCommand *d) {
+                if (auto it = hot.find(d->src->name.original); it != hot.end()) {
+                    return it->second;
+                }
+                const auto &params = d->src->_params;
+                return hot.size() + (!params.empty() && params.front()->original.type() == "VkCommandBuffer" ? 0 : 1);
+            };
+            std::stable_sort(members.begin(), members.end(), [&](const ClassCommand *a, const ClassCommand *b) { return rank(a) < rank(b); });
+
+            for (const auto &h : hot) {
+                if (std::none_of(members.begin(), members.end(), [&](const ClassCommand *d) { return d->src->name.original == h.first; })) {
+                    std::cerr << "dispatch_hot_commands: " << h.first << " is not a DeviceDispatcher command\n";
+                }
+            }
+            return members;
+        }
 
         void generateContextMembers(bool useVma, OutputClass &out, OutputBuffer &output) {
             std::unordered_map<std::string, std::pair<const char *, bool>> vma;
@@ -7188,7 +7401,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
             }
 
             // PFN function pointers
-            for (auto *d : h.filteredMembers) {
+            for (auto *d : orderedMembers()) {
                 const std::string &name = d->name.original;
 
                 const char *vmaGuard = nullptr;
@@ -7201,6 +7414,21 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                     }
                 }
 
+                if (useLazy) {
+                    gen.genOptional(out.sPublic.get(), *d, [&](auto &output) {
+                        std::string names = name + "\\0";
+                        for (const auto &alias : d->src->aliases) {
+                            names += alias.name.original + "\\0";
+                        }
+                        output += vkgen::format("    detail::LazyPFN<PFN_{0}, {1}, {3}> {0}{{ \"{2}\", std::ptrdiff_t(offsetof({3}, lazyResolver)) - std::ptrdiff_t(offsetof({3}, {0})) }};\n",
+                                                name,
+                                                h.name.original,
+                                                names,
+                                                out.name);
+                    });
+                    continue;
+                }
+
                 if (!isVma) {
                     gen.genOptional(out.sPublic.get(), *d, [&](auto &output) {
                         if (vmaGuard) {
@@ -7241,6 +7469,145 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
       public:
         DispatchGenerator(const Generator &gen, const Handle &h, bool isContext = false) : gen(gen), h(h), isContext(isContext) {}
 
+        // load() overload that resolves only commands required by a core version up to apiVersion
+        // or by an enabled extension, the rest stays null
+        void generateExtensionLoad(OutputClass &out, const std::string &args, const std::string &addrInit) {
+            struct Group
+            {
+                const vkr::Feature *feature;
+                std::string         condition;
+                OutputBuffer        body;
+            };
+
+            std::unordered_map<const vkr::Command *, const ClassCommand *> members;
+            std::unordered_map<std::string_view, const ClassCommand *>      aliases;
+            for (const auto *d : h.filteredMembers) {
+                members.emplace(d->src, d);
+                for (const auto &alias : d->src->aliases) {
+                    aliases.emplace(alias.name.original, d);
+                }
+            }
+
+            const bool                    deviceLevel = h.name == "Device";
+            std::vector<Group>            groups;
+            std::vector<std::string_view> extensionNames;
+            std::unordered_set<const ClassCommand *> always;
+            std::unordered_set<const ClassCommand *> grouped;
+
+            const auto addGroup = [&](const vkr::Feature &feature, std::string condition) {
+                auto &group = groups.emplace_back(&feature, std::move(condition));
+                for (const vkr::Command &cmd : feature.commands) {
+                    if (auto it = members.find(&cmd); it != members.end()) {
+                        if (group.condition.empty()) {
+                            always.emplace(it->second);
+                        }
+                        grouped.emplace(it->second);
+                    }
+                }
+            };
+
+            for (const auto &feature : gen.features) {
+                // number="1.2"
+                const std::string_view number = feature.version ? feature.version : "1.0";
+                const auto             dot    = number.find('.');
+                const std::string      major{ number.substr(0, dot) };
+                const std::string      minor{ dot == std::string_view::npos ? "0" : number.substr(dot + 1) };
+                addGroup(feature, (major == "1" && minor == "0") ? "" : "apiVersion >= VK_MAKE_API_VERSION(0, " + major + ", " + minor + ", 0)");
+            }
+            for (const Extension &ext : gen.extensions.ordered) {
+                if (ext.commands.empty()) {
+                    continue;
+                }
+                // extensions of the other kind are not known here, their commands are always resolved
+                if (ext.device != deviceLevel) {
+                    addGroup(ext, "");
+                    continue;
+                }
+                extensionNames.emplace_back(ext.name.original);
+            }
+            std::sort(extensionNames.begin(), extensionNames.end());
+            for (const Extension &ext : gen.extensions.ordered) {
+                if (ext.commands.empty() || ext.device != deviceLevel) {
+                    continue;
+                }
+                const auto index = std::lower_bound(extensionNames.begin(), extensionNames.end(), std::string_view{ ext.name.original }) - extensionNames.begin();
+                addGroup(ext, vkgen::format("enabled[{}]", index));
+            }
+
+            const auto load = [&](OutputBuffer &output, const ClassCommand &d) {
+                gen.genOptional(output, *d.src, [&](auto &output) {
+                    output += vkgen::format("        {0} = PFN_{0}( {1}({2}, \"{0}\") );\n", d.src->name.original, getAddr, handle);
+                });
+            };
+
+            std::unordered_set<const ClassCommand *> loaded;
+            for (auto &group : groups) {
+                for (const vkr::Command &cmd : group.feature->commands) {
+                    const auto &name = cmd.name.original;
+                    if (auto it = members.find(&cmd); it != members.end()) {
+                        const auto *d = it->second;
+                        if (group.condition.empty() ? !loaded.emplace(d).second : always.contains(d)) {
+                            continue;
+                        }
+                        load(group.body, *d);
+                    } else if (auto it = aliases.find(name); it != aliases.end()) {
+                        // promoted command whose extension name is not a member
+                        const auto &target = it->second->src->name.original;
+                        gen.genOptional(group.body, *it->second->src, [&](auto &output) {
+                            output += vkgen::format("        if ( !{0} )\n          {0} = PFN_{0}( {1}({2}, \"{3}\") );\n", target, getAddr, handle, name);
+                        });
+                    }
+                }
+            }
+
+            out.sPublic += "\n    template <typename Extensions>\n";
+            out.sPublic += "    void load(" + args + ", const Extensions &enabledExtensions, uint32_t apiVersion) {\n";
+            out.sPublic += "      *this = " + out.name + "();\n";
+            out.sPublic += addrInit;
+            if (!extensionNames.empty()) {
+                out.sPublic += "      static constexpr std::string_view extensionNames[] = {\n";
+                for (const auto &e : extensionNames) {
+                    out.sPublic += vkgen::format("        \"{}\",\n", e);
+                }
+                out.sPublic += R"(      };
+      bool enabled[std::size(extensionNames)] = {};
+      for (const auto &extension : enabledExtensions) {
+        const std::string_view name = extension;
+        const auto            *it   = std::lower_bound(std::begin(extensionNames), std::end(extensionNames), name);
+        if (it != std::end(extensionNames) && *it == name) {
+          enabled[it - std::begin(extensionNames)] = true;
+        }
+      }
+)";
+            } else {
+                out.sPublic += "      (void)enabledExtensions;\n";
+            }
+            OutputBuffer ungrouped;
+            for (const auto *d : h.filteredMembers) {
+                if (!grouped.contains(d)) {
+                    load(ungrouped, *d);
+                }
+            }
+            if (ungrouped.size() != 0) {
+                out.sPublic += "      // not required by any feature or extension\n      {\n";
+                out.sPublic += std::move(ungrouped);
+                out.sPublic += "      }\n";
+            }
+            for (auto &group : groups) {
+                if (group.body.size() == 0) {
+                    continue;
+                }
+                if (group.condition.empty()) {
+                    out.sPublic += "      // " + group.feature->name.original + "\n      {\n";
+                } else {
+                    out.sPublic += "      if ( " + group.condition + " ) {  // " + group.feature->name.original + "\n";
+                }
+                out.sPublic += std::move(group.body);
+                out.sPublic += "      }\n";
+            }
+            out.sPublic += "    }\n";
+        }
+
         void generate(OutputBuffer &output) {
             init.clear();
             init2.clear();
@@ -7260,6 +7627,11 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
             }
 
             const bool useVma = h.name == "Device" && gen.getConfig().gen.integrateVma;
+            // loader dispatcher stays eager, its PFNs are null checked by callers
+            useLazy = gen.getConfig().gen.dispatchLazy && !useVma && !isContext;
+            if (useLazy) {
+                out.sPublic += "    detail::LazyResolver<" + h.name.original + "> lazyResolver;\n";
+            }
 
             generateContextMembers(useVma, out, output);
 
@@ -7326,10 +7698,23 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                 }
 
                 out.sPublic += "    void load(" + args + ") {\n";
+                if (useLazy) {
+                    // drops PFNs resolved for a previous handle
+                    out.sPublic += "      *this = " + name + "();\n";
+                    out.sPublic += "      lazyResolver = { getProcAddr, " + handle + " };\n";
+                }
                 out.sPublic += std::move(addrInit);
                 out.sPublic += std::move(init);
                 out.sPublic += std::move(init2);
                 out.sPublic += "    }\n";
+
+                if (gen.getConfig().gen.dispatchLoadExtensions && !isContext && !useVma && !useLazy) {
+                    std::string extInit = "      " + getAddr + " = getProcAddr;\n";
+                    if (h.name == "Instance") {
+                        extInit += vkgen::format("      {0} = PFN_{0}( {1}({2}, \"{0}\") );\n", "vkGetDeviceProcAddr", getAddr, handle);
+                    }
+                    generateExtensionLoad(out, args, extInit);
+                }
             }
 
 
@@ -7408,12 +7793,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         }
         g.generate();
 
-        // TODO
-        {
-            std::stringstream str;
-            tmp.write(str);
-            out.sFuncs += str.str();
-        }
+        out.sFuncs += std::move(tmp);
     }
 
     void Generator::generateClassMembers(const Handle &data, OutputClass &out, GuardedOutputFuncs &outFuncs, Namespace ns, bool inlineFuncs) {
@@ -7472,7 +7852,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         }
     }
 
-    void Generator::generateClassConstructors(const Handle &data, OutputClass &out) {
+    void Generator::generateClassConstructors(const Handle &data, OutputClass &out, GuardedOutputFuncs &funcs) {
         const std::string &superclass = data.superclass;
 
         out.sPublic += vkgen::format(R"(
@@ -7526,7 +7906,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                 ctx.returnSingle = true;
                 MemberResolverCtor resolver{ *this, m, ctx };
 
-                resolver.generate(out.sPublic, outputFuncs);
+                resolver.generate(out.sPublic, funcs);
             }
 
             for (auto &m : const_cast<Handle &>(data).ctorCmds) {
@@ -7546,7 +7926,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                         return;
                     }
 
-                    resolver.generate(out.sPublic, outputFuncs);
+                    resolver.generate(out.sPublic, funcs);
                 };
 
                 genCtor(m);
@@ -7555,7 +7935,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 
     }
 
-    void Generator::generateClassConstructorsRAII(const Handle &data, OutputClass &out) {
+    void Generator::generateClassConstructorsRAII(const Handle &data, OutputClass &out, GuardedOutputFuncs &funcs) {
         static constexpr Namespace ns = Namespace::RAII;
 
         const auto        &superclass = data.superclass;
@@ -7572,7 +7952,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                 return;
             }
 
-            resolver.generate(out.sPublic, outputFuncsRAII);
+            resolver.generate(out.sPublic, funcs);
         };
 
         for (auto &m : const_cast<Handle &>(data).ctorCmds) {
@@ -7648,7 +8028,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                                          argDecl,
                                          m_ns_raii);
 
-            outputFuncsRAII.def.add(
+            funcs.def.add(
               data,
               [&](auto &output) {
                   output += vkgen::format(
@@ -7963,7 +8343,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 
     }
 
-    void Generator::generateClass(OutputBuffer &output, const Handle &data, bool inlineFuncs, bool noFuncs) {
+    void Generator::generateClass(OutputBuffer &output, const Handle &data, GuardedOutputFuncs &funcs, bool inlineFuncs, bool noFuncs) {
         OutputClass out {
             .name = data.name
         };
@@ -7986,7 +8366,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         }
         */
 
-        generateClassConstructors(data, out);
+        generateClassConstructors(data, out, funcs);
 
         if (cfg.gen.raii.interop && false) {
             const auto &superclass = data.superclass;
@@ -8031,7 +8411,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
             }
         }
 
-        generateDestroyMember(data, out.sPublic, outputFuncs);
+        generateDestroyMember(data, out.sPublic, funcs);
 
         out.sProtected += "    ";
 //        if (!data.isSubclass && cfg.gen.globalMode) {
@@ -8113,18 +8493,18 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         if (!noFuncs) {
             if (cfg.gen.expApi || cfg.gen.globalMode) {
                 for (ClassCommand &m : const_cast<Handle &>(data).members) {
-                    MemberGenerator g{ *this, m, out.sPublic, outputFuncs };
+                    MemberGenerator g{ *this, m, out.sPublic, funcs };
                     g.generate();
                 }
             } else {
-                generateClassMembers(data, out, outputFuncs, Namespace::VK, inlineFuncs);
+                generateClassMembers(data, out, funcs, Namespace::VK, inlineFuncs);
             }
         }
 
         output += std::move(out);
     }
 
-    void Generator::generateClassRAII(OutputBuffer &output, const Handle &data, bool asUnique) {
+    void Generator::generateClassRAII(OutputBuffer &output, const Handle &data, GuardedOutputFuncs &funcs, bool asUnique) {
         std::string className = data.name;
         if (asUnique) {
             className += "Unique";
@@ -8164,7 +8544,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                                          debugReportValue);
         }
 
-        generateClassConstructorsRAII(data, out);
+        generateClassConstructorsRAII(data, out, funcs);
 
         InitializerBuilder init("        ");
         std::string        assign = "\n";
@@ -8262,7 +8642,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                                      className);
 
         if (!exp) {
-            outputFuncsRAII.def.add(
+            funcs.def.add(
               data,
               [&](auto &output) {
                   std::string dispatchSrc;
@@ -8352,7 +8732,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
                     std::cout << "vector ctor skipped: class " << data.name << ", p: " << parent.type() << ", s: " << superclass << '\n';
                     continue;
                 }
-                r.generate(out.sPublic, outputFuncsRAII);
+                r.generate(out.sPublic, funcs);
                 passed++;
             }
 
@@ -8376,8 +8756,16 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
     }
 
     void Generator::generateClassesRAII(OutputBuffer &output, bool exp) {
+        std::vector<const Handle *> items;
         for (const Handle &h : handles.ordered) {
-            genOptional(output, h, [&](auto &output) { generateClassRAII(output, h, exp); });
+            items.push_back(&h);
+        }
+        const auto generateItem = [&](const Handle &h, ItemOutput &out) {
+            genOptional(out.output, h, [&](auto &output) { generateClassRAII(output, h, out.funcs, exp); });
+        };
+        for (auto &item : generateItems<Handle>(items, generateItem)) {
+            output += std::move(item.output);
+            outputFuncsRAII.merge(std::move(item.funcs));
         }
     }
 
@@ -8411,7 +8799,9 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 
         out.sProtected += "    LIBHANDLE lib = {};\n";
         std::string dispatchCall = "m_dispatcher";
-        if (!cfg.gen.globalMode && cfg.gen.dispatchTableAsUnique) {
+        // member type, getDispatcher() and load() must agree, global mode keeps the dispatcher by value
+        const bool  unique       = !cfg.gen.globalMode && cfg.gen.dispatchTableAsUnique;
+        if (unique) {
             out.sProtected += "    std::unique_ptr<" + dispatcher + "> m_dispatcher;\n";
             dispatchCall += "->";
         } else {
@@ -8448,7 +8838,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 )",
                                      loader.name,
                                      dispatcher,
-                                     cfg.gen.dispatchTableAsUnique ? "*" : "",
+                                     unique ? "*" : "",
                                      "", // cfg.gen.globalMode? "static " : "",
                                      " const" // cfg.gen.globalMode? "" : " const"
         );
@@ -8486,7 +8876,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 )",
             m_cast,
             dispatchCall);
-        if (cfg.gen.dispatchTableAsUnique) {
+        if (unique) {
             out.sPublic += "      m_dispatcher.reset( new " + dispatcher + "( getInstanceProcAddr ) );\n";
         } else {
             out.sPublic += "      m_dispatcher.load( getInstanceProcAddr );\n";
@@ -8693,6 +9083,12 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         cfg.reset();
     }
 
+    void Generator::resetConfigState() {
+        resetConfig();
+        restoreTypeStates(loadedTypeStates);
+        orderedCommands.clear();
+    }
+
     void Generator::loadConfigPreset() {
         resetConfig();
     }
@@ -8706,12 +9102,19 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
     }
 
     bool Generator::load(const std::string &xmlPath) {
+        Trace::Scope trace{ "load" };
         auto start   = std::chrono::system_clock::now();
+        loadedTypeStates.clear();
         auto result  = VulkanRegistry::load(*this, xmlPath);
         if (result) {
+            loadedTypeStates = saveTypeStates();
             auto end     = std::chrono::system_clock::now();
             auto elapsed = std::chrono::duration<double>(end - start);
-            std::cout << "loaded in " << elapsed.count() << "s\n";
+            std::cout << "loaded in " << elapsed.count() << "s (vk.xml: " << getLoadTime() << "s";
+            if (video && video->isLoaded()) {
+                std::cout << ", video.xml: " << video->getLoadTime() << "s";
+            }
+            std::cout << ")\n";
         }
         return result;
     }
@@ -8742,6 +9145,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 
         cfg.gen.expApi = cfg.gen.globalMode;
 
+        Trace::Scope trace{ "generate" };
         auto start = std::chrono::system_clock::now();
 
         std::string p = outputFilePath;
@@ -8764,6 +9168,17 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         outputToStringDef.clear();
         outputFuncs.clear();
         outputFuncsRAII.clear();
+        filesWritten      = 0;
+        filesUnchanged    = 0;
+        memberMethods     = 0;
+        memberAllocations = 0;
+        memberAllocBytes  = 0;
+
+        // blocks depend on the registry, saved config options, enabled states and the generator build itself
+        genCache.open(path);
+        genCacheKey = hashFnv1a(buildId());
+        genCacheKey = hashValue(getXmlHash(), genCacheKey);
+        genCacheKey = hashValue(cfg.hashOptions(), genCacheKey);
 
         const auto &contextClassName = cfg.gen.contextClassName.data;
         if (contextClassName.empty()) {
@@ -8778,12 +9193,29 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
 
         cvars.uniqueDispatch.setType(cfg.macro.mDispatchType.get());
 
-        generateApiVideo(videoPath);
-        generateApiC(vulkanPath);
-        generateApiCpp(vulkanPath);
+        // C and video headers only read the registry, so they are emitted on separate threads.
+        // Video types are not touched by the C++ path, C generation has to finish before commands are prepared.
+        auto videoTask = std::async(std::launch::async, [&] { generateApiVideo(videoPath); });
+        auto cTask     = std::async(std::launch::async, [&] { generateApiC(vulkanPath); });
+
+        generateApiCpp(vulkanPath, &cTask);
+
+        videoTask.get();
 
         auto end     = std::chrono::system_clock::now();
         auto elapsed = std::chrono::duration<double>(end - start);
+        if (genCache.isEnabled()) {
+            std::cout << "generation cache: " << genCache.getHits() << " reused, " << genCache.getMisses() << " generated" << std::endl;
+            genCache.save();
+            genCache.close();
+        }
+        std::cout << "files: " << filesWritten << " written, " << filesUnchanged << " unchanged" << std::endl;
+        if (printOutputStats && memberMethods && !AllocStats::enabled()) {
+            std::cout << "member emission: " << memberMethods << " methods, allocations not counted (build with GENERATOR_ALLOC_STATS)" << std::endl;
+        } else if (printOutputStats && memberMethods) {
+            std::cout << "member emission: " << memberMethods << " methods, " << memberAllocations << " allocations ("
+                      << static_cast<double>(memberAllocations) / memberMethods << " per method), " << memberAllocBytes << " bytes" << std::endl;
+        }
         std::cout << "generated in " << elapsed.count() << "s" << std::endl;
     }
 
@@ -8798,6 +9230,7 @@ extern "C" __declspec( dllimport ) FARPROC __stdcall GetProcAddress( HINSTANCE h
         if (!isLoaded()) {
             throw std::runtime_error("Can't load config: registry is not loaded");
         }
+        Trace::Scope trace{ "loadConfig" };
         cfg.load(*this, filename);
     }
 
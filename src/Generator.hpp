@@ -19,11 +19,15 @@
 #ifndef GENERATOR_HPP
 #define GENERATOR_HPP
 
+#include "AllocStats.hpp"
 #include "Config.hpp"
+#include "GenerationCache.hpp"
 #include "Members.hpp"
 #include "Output.hpp"
 #include "Registry.hpp"
 
+#include <atomic>
+#include <future>
 #include <string>
 #include <optional>
 #include <variant>
@@ -140,6 +144,31 @@ namespace vkgen
         GuardedOutputFuncs outputFuncs;
         GuardedOutputFuncs outputFuncsRAII;
 
+        // 0 = one per hardware thread
+        size_t jobs             = 1;
+        bool   verifyJobs       = false;
+        bool   printOutputStats = false;
+
+        std::atomic<size_t> filesWritten   = 0;
+        std::atomic<size_t> filesUnchanged = 0;
+
+        mutable std::atomic<size_t> memberMethods     = 0;
+        mutable std::atomic<size_t> memberAllocations = 0;
+        mutable std::atomic<size_t> memberAllocBytes  = 0;
+
+        GenerationCache genCache;
+        uint64_t        genCacheKey = {};
+
+        std::vector<TypeState> loadedTypeStates;
+
+        // hash of inputs that influence generated block of the item
+        uint64_t itemCacheKey(const Enum &data) const;
+
+        uint64_t itemCacheKey(const Struct &data) const;
+
+        template <typename T>
+        std::vector<ItemOutput> generateItems(const std::vector<const T *> &items, const std::function<void(const T &, ItemOutput &)> &func);
+
         // std::string genWithProtect(const std::string &code, const std::string &protect) const;
 
         // std::string genWithProtectNegate(const std::string &code, const std::string &protect) const;
@@ -184,13 +213,14 @@ namespace vkgen
 
         void generateApiC(std::filesystem::path path);
 
-        void generateApiCpp(std::filesystem::path path);
+        // readers is joined before handles and structs are generated, they mutate command and member variables
+        void generateApiCpp(std::filesystem::path path, std::future<void> *readers = nullptr);
 
         void generateForwardHandles(OutputBuffer &output);
 
-        void generateEnumStr(const Enum &data, OutputBuffer &output);
+        void generateEnumStr(const Enum &data, OutputBuffer &output, GuardedOutputFuncs &toString);
 
-        void generateEnum(const Enum &data, OutputBuffer &output, OutputBuffer &output_forward);
+        void generateEnum(const Enum &data, ItemOutput &out);
 
         std::string generateToStringInclude() const;
 
@@ -293,15 +323,15 @@ namespace vkgen
 
         void generateStructChains(OutputBuffer &output, bool ctype = false);
 
-        bool generateStructConstructor(OutputBuffer &output, const Struct &data, bool transform);
+        bool generateStructConstructor(OutputBuffer &output, const Struct &data, bool transform, GuardedOutputFuncs &funcs);
 
-        void generateStruct(OutputBuffer &output, const Struct &data, bool exp);
+        void generateStruct(OutputBuffer &output, const Struct &data, bool exp, GuardedOutputFuncs &funcs);
 
         std::string generateIncludeRAII(GenOutput &out) const;
 
         void generateDestroyMember(const Handle &h, GuardedOutput &decl, GuardedOutputFuncs &def);
 
-        void generateClassWithPFN(OutputBuffer &output, Handle &h);
+        void generateClassWithPFN(OutputBuffer &output, Handle &h, GuardedOutputFuncs &funcs);
 
         void generateContext(OutputBuffer &output);
 
@@ -363,9 +393,9 @@ namespace vkgen
                                   Namespace                ns,
                                   bool                     inlineFuncs = false);
 
-        void generateClassConstructors(const Handle &data, OutputClass &out);
+        void generateClassConstructors(const Handle &data, OutputClass &out, GuardedOutputFuncs &funcs);
 
-        void generateClassConstructorsRAII(const Handle &data, OutputClass &out);
+        void generateClassConstructorsRAII(const Handle &data, OutputClass &out, GuardedOutputFuncs &funcs);
 
         void generateUniqueClassStr(OutputBuffer &output, const Handle &data, bool inlineFuncs);
 
@@ -377,10 +407,11 @@ namespace vkgen
 
         void generateClass(OutputBuffer &output,
                            const Handle            &data,
+                           GuardedOutputFuncs      &funcs,
                                      bool                     inlineFuncs,
                                      bool                     noFuncs = false);
 
-        void generateClassRAII(OutputBuffer &output, const Handle &data, bool asUnique = false);
+        void generateClassRAII(OutputBuffer &output, const Handle &data, GuardedOutputFuncs &funcs, bool asUnique = false);
 
         void generateClassesRAII(OutputBuffer &output, bool exp = false);
 
@@ -425,6 +456,9 @@ namespace vkgen
 
         void resetConfig();
 
+        // restores options, whitelist state and struct member types as they were right after load, so another config can be applied
+        void resetConfigState();
+
         void loadConfigPreset();
 
         void setOutputFilePath(const std::string &path);
@@ -437,6 +471,41 @@ namespace vkgen
             return outputFilePath;
         }
 
+        // number of threads for per-item generation of enums, structs and handle classes
+        void setJobs(size_t count) {
+            jobs = count;
+        }
+
+        // regenerate every item serially and compare it with the parallel result
+        void setVerifyJobs(bool enabled) {
+            verifyJobs = enabled;
+        }
+
+        // print buffer fragment and allocation counts for every written file
+        void setPrintOutputStats(bool enabled) {
+            printOutputStats = enabled;
+        }
+
+        bool isPrintOutputStats() const {
+            return printOutputStats;
+        }
+
+        // called from GenOutput::writeFile, possibly from several threads
+        void countOutputFile(bool written) {
+            if (written) {
+                filesWritten++;
+            } else {
+                filesUnchanged++;
+            }
+        }
+
+        // called from MemberResolver::generate for every emitted method
+        void countMemberAllocations(const AllocStats::Counters &counters) const {
+            memberMethods++;
+            memberAllocations += counters.count;
+            memberAllocBytes += counters.bytes;
+        }
+
         bool load(const std::string &xmlPath);
 
         void generate();
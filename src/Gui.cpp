@@ -1121,7 +1121,7 @@ vkgen::GUI::GUI(vkgen::Generator &gen) {
       "##TableNS",
       "General",
       0,
-      std::make_unique<RenderableColumn<11>>(
+      std::make_unique<RenderableColumn<14>>(
         0,
         std::make_unique<RenderableText>("Variant"),
         make_config_option(0, BoolGUI{ &cfg.gen.globalMode.data, "vkg mode" }, "Vulkan with global functions"),
@@ -1133,6 +1133,9 @@ vkgen::GUI::GUI(vkgen::Generator &gen) {
         // make_config_option(0, BoolGUI{&cfg.gen.exceptions.data, "exceptions"}, "enable vulkan exceptions"),
         // make_config_option(0, BoolGUI{ &cfg.gen.expApi.data, "Dynamic PFN linking" }, "PFN dispatcher will be embedded to Device and Instance"),
         make_config_option(Level::L2, 0, NestedOption<BoolGUI>{ &cfg.gen.integrateVma.data, "Integrate VMA" }, "PFN dispatcher can be used with VMA"),
+        make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.dispatchLazy.data, "Lazy dispatcher loading" }, "Instance and Device PFNs are resolved on first call instead of in load()"),
+        make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.dispatchLoadExtensions.data, "Extension-aware load()" }, "Dispatcher load() overload taking enabled extensions and API version, other PFNs stay null"),
+        make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.dispatchHotLayout.data, "Hot dispatcher layout" }, "DeviceDispatcher declares command buffer PFNs (and the hot list) first"),
         make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.proxyPassByCopy.data, "Pass ArrayProxy as copy" }, "Pass ArrayProxy parameter as copy instead of reference"),
         make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.unifiedException.data, "Unified exception" }, "Generates only vk::Error exeption"),
         make_config_option(Level::L2, 0, BoolGUI{ &cfg.gen.branchHint.data, "Branch hints" }, "Add compiler C++20 hints (likely, unlikely)")),
@@ -1368,6 +1371,7 @@ void vkgen::GUI::mainScreen() {
             InputText("Namespace", &cfg.macro.mNamespace.data.value);
             InputText("vk::Context name", &cfg.gen.contextClassName.data);
             InputText("Module name", &cfg.gen.moduleName.data);
+            InputText("Hot dispatch commands", &cfg.gen.dispatchHotCommands.data);
             PopItemWidth();
         }
 
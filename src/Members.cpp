@@ -23,6 +23,8 @@
 #include "Generator.hpp"
 
 #include <cassert>
+#include <iterator>
+#include <optional>
 
 namespace vkgen
 {
@@ -72,8 +74,7 @@ namespace vkgen
         return out;
     }
 
-    std::string MemberResolver::generateDeclaration() {
-        std::string output;
+    void MemberResolver::generateDeclaration(std::string &output) {
         if (ctx.commentOut) {
             output += "/*\n";
         }
@@ -90,21 +91,21 @@ namespace vkgen
 //            output += "// void\n";
 //        }
 
-        output += getProto(indent, "(declaration)", name, true, usesTemplate) + ";\n\n";
+        output += getProto(indent, "(declaration)", name, true, usesTemplate);
+        output += ";\n\n";
 
         if (gen.getConfig().gen.extendedFunctions && !constructor && !ctx.suffixThrow && !ctx.suffixNoThrow) {
             // output += "// alias\n";
-            output += getProto(indent, "(declaration)", name + (isNothrow? "_noThrow" : "_throw"), true, usesTemplate) + ";\n\n";
+            output += getProto(indent, "(declaration)", name + (isNothrow? "_noThrow" : "_throw"), true, usesTemplate);
+            output += ";\n\n";
         }
 
         if (ctx.commentOut) {
             output += "*/\n";
         }
-        return output;
     }
 
-    std::string MemberResolver::generateDefinition(bool genInline, bool bypass) {
-        std::string output;
+    void MemberResolver::generateDefinition(std::string &output, bool genInline, bool bypass) {
         if (ctx.commentOut) {
             output += "/*\n";
         }
@@ -113,7 +114,8 @@ namespace vkgen
 
         // if (last) output += "// last: " + last->fullType(gen) + "\n";
         bool usesTemplate = false;
-        output += getProto(indent, "(definition)", name, genInline, usesTemplate) + "\n    {\n";
+        output += getProto(indent, "(definition)", name, genInline, usesTemplate);
+        output += "\n    {\n";
         if (ctx.ns == Namespace::RAII && isIndirect() && !constructor) {
             if (cls->ownerhandle.empty()) {
                 std::cerr << "Error: can't generate function: class has "
@@ -131,7 +133,7 @@ namespace vkgen
                 if (p.isLenAttribIndirect()) {
                     const auto       &var  = p.getLengthVar();
                     std::string const size = var->identifier() + "." + p.getLenAttribRhs();
-                    output += "    // VULKAN_HPP_ASSERT (" + p.identifier() + ".size()" + " == " + size + ")\n";
+                    vkgen::format_to(std::back_inserter(output), "    // VULKAN_HPP_ASSERT ({}.size() == {})\n", p.identifier(), size);
                 }
             }
         }
@@ -141,15 +143,18 @@ namespace vkgen
         output += Inst::bodyStart(ctx.ns, name.original);
 #endif
 
-        output += generateMemberBody();
+        generateMemberBody(output);
 
         if (generateReturnType() != "void" && !returnValue.empty()) {
-            output += "      return " + returnValue + ";\n";
+            output += "      return ";
+            output += returnValue;
+            output += ";\n";
         }
         output += "    }\n\n";
 
         if (gen.getConfig().gen.extendedFunctions && !constructor && !ctx.suffixThrow && !ctx.suffixNoThrow) {
-            output += getProto(indent, "(definition)", name + (isNothrow? "_noThrow" : "_throw"), genInline, usesTemplate) + "\n    {\n";
+            output += getProto(indent, "(definition)", name + (isNothrow? "_noThrow" : "_throw"), genInline, usesTemplate);
+            output += "\n    {\n";
             output += "      ";
             if (returnType != "void") {
                 output += "return ";
@@ -158,7 +163,8 @@ namespace vkgen
                 output += "this->";
             }
             else {
-                output += gen.m_ns + "::";
+                output += gen.m_ns;
+                output += "::";
             }
             output += name;
             std::string temp;
@@ -183,14 +189,15 @@ namespace vkgen
                 output += std::move(temp);
                 output += ">";
             }
-            output += "(" + createAliasArguments() + ");\n";
+            output += "(";
+            output += createAliasArguments();
+            output += ");\n";
             output += "    }\n\n";
         }
 
         if (ctx.commentOut) {
             output += "*/\n";
         }
-        return output;
     }
 
     std::string MemberResolver::createArgumentWithType(const std::string &type) const {
@@ -399,9 +406,9 @@ namespace vkgen
         return out;
     }
 
-    std::string MemberResolver::declareReturnVar(const std::string &assignment) {
+    bool MemberResolver::declareResultVar() {
         if (!resultVar.isInvalid()) {
-            return "";
+            return false;
         }
         resultVar.setSpecialType(VariableData::TYPE_DEFAULT);
         resultVar.setIdentifier("result");
@@ -410,7 +417,13 @@ namespace vkgen
         } else {
             resultVar.setFullType("", "Result", "");
         }
+        return true;
+    }
 
+    std::string MemberResolver::declareReturnVar(const std::string &assignment) {
+        if (!declareResultVar()) {
+            return "";
+        }
         std::string out = resultVar.toString(gen);
         if (!assignment.empty()) {
             out += " = " + assignment;
@@ -418,9 +431,7 @@ namespace vkgen
         return out += ";\n";
     }
 
-    std::string MemberResolver::generateMemberBody() {
-        return "";
-    };
+    void MemberResolver::generateMemberBody(std::string &output) {}
 
     std::string MemberResolver::castTo(const std::string &type, const std::string &src) const {
         if (type != cmd->type) {
@@ -495,35 +506,51 @@ namespace vkgen
         return output;
     }
 
-    std::string MemberResolver::generatePFNcall(bool immediateReturn) {
-        std::string call = getDispatchPFN();
-        call += "(" + createPFNArguments() + ")";
-
+    void MemberResolver::generatePFNcall(std::string &output, bool immediateReturn) {
         using enum Command::PFNReturnCategory;
+        // casts around the call, outer one first
+        std::optional<std::string_view> casts[2];
+        std::string_view                end    = ";";
+        bool                            assign = false;
         switch (cmd->pfnReturn) {
             case VK_RESULT:
-                call = castTo(gen.getConfig().gen.internalVkResult ? "VkResult" : "Result", call);
-                if (!immediateReturn) {
-                    return assignToResult(call);
-                }
+                casts[1] = gen.getConfig().gen.internalVkResult ? "VkResult" : "Result";
+                assign   = !immediateReturn;
                 break;
-            case OTHER: call = castTo(returnType, call); break;
-            case VOID: return call + ";";
+            case OTHER: casts[1] = returnType; break;
+            case VOID: immediateReturn = false; break;
             default: break;
         }
         if (immediateReturn) {
-            call = castTo(returnType, call);
-            call = "return " + call;
+            casts[0] = returnType;
+            output += "return ";
+        }
+        else if (assign) {
+            if (declareResultVar()) {
+                output += resultVar.toString(gen);
+                end = ";\n";
+            }
+            else {
+                output += resultVar.identifier();
+            }
+            output += " = ";
         }
-        return call + ";";
-    }
 
-    std::string MemberResolver::assignToResult(const std::string &assignment) {
-        if (resultVar.isInvalid()) {
-            return declareReturnVar(assignment);
-        } else {
-            return resultVar.identifier() + " = " + assignment + ";";
+        size_t opened = 0;
+        for (const auto &type : casts) {
+            if (type && *type != cmd->type) {
+                output += "static_cast<";
+                output += *type;
+                output += ">(";
+                opened++;
+            }
         }
+        output += getDispatchPFN();
+        output += "(";
+        output += createPFNArguments();
+        output += ")";
+        output.append(opened, ')');
+        output += end;
     }
 
     std::string MemberResolver::generateReturnValue(const std::string &identifier) {
@@ -881,6 +908,7 @@ namespace vkgen
             return;
         }
 
+        lock.emplace(*cmd);
         if (!cmd->prepared) {
             dbgfield += "    // params restore()\n";
         }
@@ -1047,6 +1075,7 @@ namespace vkgen
 //    }
 
     void MemberResolver::generate(GuardedOutput &decl, GuardedOutputFuncs &def, const std::span<Protect> opt) {
+        const auto allocations = AllocStats::current();
         setOptionalAssignments();
 
         if (gen.getConfig().dbg.methodTags) {
@@ -1082,31 +1111,37 @@ namespace vkgen
         else if (gen.getConfig().gen.cppFiles && !isTemplated()) {
             specifierInline = false;
         }
+        // methods are emitted into a reused buffer and copied into the output arena once
+        thread_local std::string str;
+        str.clear();
         if (ctx.generateInline) {
-            decl.get(protects) += generateDefinition(true); // TODO move
+            generateDefinition(str, true);
+            decl.get(protects).append(str);
         }
         else {
-            decl.get(protects) += generateDeclaration(); // TODO move
-            std::string str;
+            generateDeclaration(str);
+            decl.get(protects).append(str);
+            str.clear();
 //            str = " // ";
 //            for (const auto &p : protects) {
 //                str += p.first;
 //                str += " ->";
 //            }
 //            str += '\n';
-            str += generateDefinition(false);
+            generateDefinition(str, false);
             if (!p.empty()) {
-                def.platform.get(protects) += str;
+                def.platform.get(protects).append(str);
             }
             else if (isTemplated()) {
-                def.templ.get(protects) += str;
+                def.templ.get(protects).append(str);
             }
             else {
-                def.def.get(protects) += str;
+                def.def.get(protects).append(str);
             }
         }
 
         reset();
+        gen.countMemberAllocations(AllocStats::current() - allocations);
     }
 
     void MemberResolver::disableFirstOptional() {
@@ -2100,7 +2135,8 @@ namespace vkgen
                 }
             }
 
-            std::string call = generatePFNcall();
+            std::string call;
+            generatePFNcall(call);
 
             std::string resizeCode;
             std::string downsizeCode;
@@ -2190,7 +2226,8 @@ namespace vkgen
                 }
             }
 
-            std::string callNullptr = generatePFNcall();
+            std::string callNullptr;
+            generatePFNcall(callNullptr);
 
             if (cmd->pfnReturn == Command::PFNReturnCategory::VK_RESULT) {
                 std::string cond = successCodesCondition(resultVar.identifier());
@@ -2198,7 +2235,7 @@ namespace vkgen
                 std::string resultSuccess    = cfg.gen.internalVkResult ? "VK_SUCCESS" : "Result::eSuccess";
                 std::string resultIncomplete = cfg.gen.internalVkResult ? "VK_INCOMPLETE" : "Result::eIncomplete";
 
-                output += vkgen::format(R"(
+                vkgen::format_to(std::back_inserter(output), R"(
     do {{
       {0}
       if (result == {1} && {2}) {3}{{
@@ -2209,7 +2246,7 @@ namespace vkgen
                                         cfg.gen.branchHint? "VULKAN_HPP_LIKELY " : "");
 
                 output += resizeCode;
-                output += vkgen::format(R"(
+                vkgen::format_to(std::back_inserter(output), R"(
         {0}
       }}
     }} while (result == {1});
@@ -2218,9 +2255,13 @@ namespace vkgen
                                         resultIncomplete);
 
             } else {
-                output += "      " + callNullptr + "\n";
+                output += "      ";
+                output += callNullptr;
+                output += '\n';
                 output += resizeCode;
-                output += "      " + call + "\n";
+                output += "      ";
+                output += call;
+                output += '\n';
             }
 
             output += generateCheck();
@@ -2228,8 +2269,7 @@ namespace vkgen
             output += downsizeCode;
     }
 
-    std::string MemberResolverDefault::generateMemberBody() {
-        std::string output;
+    void MemberResolverDefault::generateMemberBody(std::string &output) {
         const auto &cfg = gen.getConfig();
         const bool  dbg = cfg.dbg.methodTags;
         if (dbg) {
@@ -2248,14 +2288,15 @@ namespace vkgen
              generateMemberBodyArray(output, returnId, returnsRAII, vectorSizeVar, dbg);
         }
         else {
-            output += "      " + generatePFNcall(immediate && !constructor) + "\n";
+            output += "      ";
+            generatePFNcall(output, immediate && !constructor);
+            output += '\n';
             if (cmd->pfnReturn != Command::PFNReturnCategory::VOID) {
                 output += generateCheck();
             }
         }
 
         const auto createEmplaceRAII = [&]() {
-            std::string output;
             for (const VariableData &v : cmd->outParams) {
                 const std::string &id     = v.identifier();
                 const auto        &handle = gen.findHandle(v.original.type());
@@ -2279,7 +2320,7 @@ namespace vkgen
                     hasPoolArg = true;
                 }
 
-                output += vkgen::format(R"(
+                vkgen::format_to(std::back_inserter(output), R"(
     {0}reserve({1}.size());
     for (auto const &{2} : {3}) {{
       {0}emplace_back({4}, {2}{5});
@@ -2292,8 +2333,6 @@ namespace vkgen
                                         arg,
                                         poolArg);
             }
-
-            return output;
         };
 
         if (returnsRAII) {
@@ -2334,7 +2373,7 @@ for (auto const &{2} : {3}) {
             }*/
 
             const VariableData &v = cmd->outParams[0];
-            output += createEmplaceRAII();
+            createEmplaceRAII();
             returnId = "_" + v.identifier();
         }
 
@@ -2407,8 +2446,6 @@ for (auto const &{2} : {3}) {
 //                }
 //            }
 //        }
-
-        return output;
     }
 
     MemberResolverDefault::MemberResolverDefault(const Generator &gen, ClassCommand &d, MemberContext &ctx, bool constructor)
@@ -2449,9 +2486,7 @@ for (auto const &{2} : {3}) {
                              call);
     }
 
-    std::string MemberResolverStaticDispatch::generateMemberBody() {
-        return "";
-    }
+    void MemberResolverStaticDispatch::generateMemberBody(std::string &output) {}
 
 
     MemberResolverDestroy::MemberResolverDestroy(const Generator &gen, ClassCommand &d, MemberContext &ctx) : MemberResolverDefault(gen, d, ctx) {
@@ -2506,9 +2541,7 @@ for (auto const &{2} : {3}) {
         return call;
     }
 
-    std::string MemberResolverClearRAII::generateMemberBody() {
-        return "";
-    }
+    void MemberResolverClearRAII::generateMemberBody(std::string &output) {}
 
 //    MemberResolverStaticVector::MemberResolverStaticVector(const Generator &gen, ClassCommand &d, MemberContext &ctx) : MemberResolverDefault(gen, d, ctx) {
 //        int converted = 0;
@@ -2581,9 +2614,8 @@ for (auto const &{2} : {3}) {
         dbgtag = "RAII vector";
     }
 
-    std::string MemberResolverVectorRAII::generateMemberBody() {
-        std::string args = createPassArguments(true);
-        return "      return " + last->namespaceString(gen) + last->type() + "s(" + args + ");\n";
+    void MemberResolverVectorRAII::generateMemberBody(std::string &output) {
+        vkgen::format_to(std::back_inserter(output), "      return {}{}s({});\n", last->namespaceString(gen), last->type(), createPassArguments(true));
     }
 
     MemberResolverCtor::MemberResolverCtor(const Generator &gen, ClassCommand &d, MemberContext &refCtx)
@@ -2700,41 +2732,38 @@ for (auto const &{2} : {3}) {
         return s;
     }
 
-    std::string MemberResolverCtor::generateMemberBody() {
-        std::string output;
-
+    void MemberResolverCtor::generateMemberBody(std::string &output) {
         const std::string &owner = cls->ownerhandle;
         if (!owner.empty() && !constructorInterop && !ctx.exp) {
-            output += "      " + owner + " = " + superclassSource.getSuperclassAssignment() + ";\n";
+            vkgen::format_to(std::back_inserter(output), "      {} = {};\n", owner, superclassSource.getSuperclassAssignment());
         }
 
-        std::string call = generatePFNcall();
-
-        output += "      " + call + "\n";
+        output += "      ";
+        generatePFNcall(output);
+        output += '\n';
         output += generateCheck();
 
         if (!cls->isSubclass && !constructorInterop) {
             const auto &superclass = cls->superclass;
             const auto &cfg = gen.getConfig();
-            bool unique = !(cfg.gen.globalMode || cfg.gen.expApi) || cfg.gen.dispatchTableAsUnique;
+            // generateClassWithPFN (global and exp mode) holds the dispatcher by value
+            bool unique = !(cfg.gen.globalMode || cfg.gen.expApi);
             unique &= !(cls->name == "Instance" && cfg.gen.raii.staticInstancePFN);
             unique &= !(cls->name == "Device" && cfg.gen.raii.staticDevicePFN);
 
             if (unique) {
-                output += vkgen::format("      m_dispatcher.reset( new {2}Dispatcher( {1}, {3} ) );\n",
+                vkgen::format_to(std::back_inserter(output), "      m_dispatcher.reset( new {2}Dispatcher( {1}, {3} ) );\n",
                                         superclass,
                                         src,
                                         cls->name,
                                         cls->vkhandle.toArgument(gen));
             } else {
                 // std::string first = cfg.gen.integrateVma? getDispatchDeref() : getDispatchSource() + "vkGet" + cls->name + "ProcAddr";
-                output += vkgen::format(
+                vkgen::format_to(std::back_inserter(output),
                   // "      m_dispatcher = {0}Dispatcher( {1}vkGet{0}ProcAddr, {2} );\n", cls->name, getDispatchSource(), cls->vkhandle.toArgument(gen));
                   "      m_dispatcher = {0}Dispatcher( {1}, {2} );\n", cls->name, src, cls->vkhandle.toArgument(gen));
             }
         }
-
-        return output;
     }
 
     MemberResolverInit::MemberResolverInit(const Generator &gen, ClassCommand &d, MemberContext &refCtx) :
@@ -2747,17 +2776,15 @@ for (auto const &{2} : {3}) {
             : "void";
     }
 
-    std::string MemberResolverInit::generateMemberBody() {
-        std::string output;
-
-        std::string call = generatePFNcall();
-
-        output += "      " + call + "\n";
+    void MemberResolverInit::generateMemberBody(std::string &output) {
+        output += "      ";
+        generatePFNcall(output);
+        output += '\n';
         bool hasResult = cmd->pfnReturn == Command::PFNReturnCategory::VK_RESULT;
         if (hasResult) {
-            output += "      if(" + resultVar.identifier() + " == VK_SUCCESS) {\n  ";
+            vkgen::format_to(std::back_inserter(output), "      if({} == VK_SUCCESS) {{\n  ", resultVar.identifier());
         }
-        output += vkgen::format("      m_dispatcher = {0}Dispatcher( {1}, {2} );\n", cls->name, src, cls->vkhandle.toArgument(gen));
+        vkgen::format_to(std::back_inserter(output), "      m_dispatcher = {0}Dispatcher( {1}, {2} );\n", cls->name, src, cls->vkhandle.toArgument(gen));
 
         if (hasResult) {
             output += "      }\n";
@@ -2771,7 +2798,6 @@ for (auto const &{2} : {3}) {
             }
 
         }
-        return output;
     }
 
 
@@ -2793,8 +2819,8 @@ for (auto const &{2} : {3}) {
         dbgtag            = "vector constructor";
     }
 
-    std::string MemberResolverVectorCtor::generateMemberBody() {
-        return MemberResolverDefault::generateMemberBody();
+    void MemberResolverVectorCtor::generateMemberBody(std::string &output) {
+        MemberResolverDefault::generateMemberBody(output);
     }
 
     MemberResolverUniqueCtor::MemberResolverUniqueCtor(Generator &gen, ClassCommand &d, MemberContext &refCtx) : MemberResolverDefault(gen, d, refCtx, true) {
@@ -2827,9 +2853,7 @@ for (auto const &{2} : {3}) {
         dbgtag             = "unique constructor";
     }
 
-    std::string MemberResolverUniqueCtor::generateMemberBody() {
-        return "";
-    }
+    void MemberResolverUniqueCtor::generateMemberBody(std::string &output) {}
 
     MemberResolverCreateHandleRAII::MemberResolverCreateHandleRAII(Generator &gen, ClassCommand &d, MemberContext &refCtx)
       : MemberResolverDefault(gen, d, refCtx) {
@@ -2838,11 +2862,11 @@ for (auto const &{2} : {3}) {
         dbgtag = "create handle raii";
     }
 
-    std::string MemberResolverCreateHandleRAII::generateMemberBody() {
+    void MemberResolverCreateHandleRAII::generateMemberBody(std::string &output) {
         const bool returnsSubclass = gen.findHandle(last->original.type()).isSubclass;
 
         if (last->isArray() && !ctx.returnSingle) {
-            return MemberResolverDefault::generateMemberBody();
+            MemberResolverDefault::generateMemberBody(output);
         } else if (gen.getConfig().gen.expApi && cls->isSubclass && !returnsSubclass) {
             //                        last->setIdentifier("handle");
             //                        last->setAltPFN("std::bit_cast<" + last->original.type() + "*>(&handle)");
@@ -2851,16 +2875,16 @@ for (auto const &{2} : {3}) {
             //                        output += generateCheck();
             //                        output += "    return " + returnType + "(handle);\n";
             cmd->params[0].get().setNamespace(Namespace::VK);
-            return vkgen::format(R"(      return {0}(*{1}, {2});
+            vkgen::format_to(std::back_inserter(output), R"(      return {0}(*{1}, {2});
 )",
-                                 returnType,
-                                 cls->ownerhandle,
-                                 createPassArgumentsRAII());
+                             returnType,
+                             cls->ownerhandle,
+                             createPassArgumentsRAII());
         } else {
-            return vkgen::format(R"(      return {0}({1});
+            vkgen::format_to(std::back_inserter(output), R"(      return {0}({1});
 )",
-                                 returnType,
-                                 createPassArgumentsRAII());
+                             returnType,
+                             createPassArgumentsRAII());
         }
     }
 
@@ -2898,16 +2922,15 @@ for (auto const &{2} : {3}) {
         }
     }
 
-    std::string MemberResolverCreate::generateMemberBody() {
-        std::string output;
-
+    void MemberResolverCreate::generateMemberBody(std::string &output) {
         if (ctx.globalModeStatic && !ctx.returnSingle) {
-            output += MemberResolverDefault::generateMemberBody();
-            return output;
+            MemberResolverDefault::generateMemberBody(output);
+            return;
         }
 
         if (last->isArray() && !ctx.returnSingle) {
-            return MemberResolverDefault::generateMemberBody();
+            MemberResolverDefault::generateMemberBody(output);
+            return;
         }
 
         if (ctx.returnSingle && last->isLenAttribIndirect()) {
@@ -2937,15 +2960,17 @@ for (auto const &{2} : {3}) {
                     }
                 }
                 args += createPassArguments(true);
-                output += "      return " + last->fullType(gen) + "(" + args + ");\n";
-                return output;
+                vkgen::format_to(std::back_inserter(output), "      return {}({});\n", last->fullType(gen), args);
+                return;
             }
         }
 
         const auto &id = last->identifier();
-        output += "      " + last->original.type() + " " + id + ";\n";
-        output += "      " + generatePFNcall();
-        output += "      " + generateCheck();
+        vkgen::format_to(std::back_inserter(output), "      {} {};\n", last->original.type(), id);
+        output += "      ";
+        generatePFNcall(output);
+        output += "      ";
+        output += generateCheck();
 
         if (gen.getConfig().gen.globalMode) {
             returnValue = id;
@@ -2953,13 +2978,14 @@ for (auto const &{2} : {3}) {
         else {
             returnValue = last->fullType(gen) + "(" + id + ")";
         }
-        return output;
+        return;
 
         if (ctx.isStatic) {
             // output += "      " + last->original.type() + " = " + cmd->name.original + "\n";
             const auto &id = last->identifier();
             output += "      " + last->original.type() + " " + id + ";\n";
-            output += "      " + generatePFNcall();
+            output += "      ";
+            generatePFNcall(output);
             output += "      " + generateCheck();
 
             if (gen.getConfig().gen.globalMode) {
@@ -3000,16 +3026,15 @@ for (auto const &{2} : {3}) {
                 args += createPassArguments(true);
                 output += "      return " + last->fullType(gen) + "(" + args + ");\n";
             } else {
-                const std::string &call = generatePFNcall();
-                std::string        id   = last->identifier();
+                std::string call;
+                generatePFNcall(call);
+                std::string id = last->identifier();
                 output += "      " + last->fullType(gen) + " " + id + ";\n";
                 output += "      " + call + "\n";
                 output += generateCheck();
                 returnValue = generateReturnValue(id);
             }
         }
-
-        return output;
     }
 
     MemberResolverCreateUnique::MemberResolverCreateUnique(const Generator &gen, ClassCommand &d, MemberContext &refCtx) : MemberResolverCreate(gen, d, refCtx) {
@@ -3077,9 +3102,7 @@ for (auto const &{2} : {3}) {
 //        first.setIgnorePass(true);
     }
 
-    std::string MemberResolverCreateUnique::generateMemberBody() {
-        std::string output;
-
+    void MemberResolverCreateUnique::generateMemberBody(std::string &output) {
         std::string deleter;
         if (!ctx.globalModeStatic) {
 
@@ -3110,21 +3133,21 @@ for (auto const &{2} : {3}) {
         if (uniqueVector) {
             const bool dbg = false;
 
-            output += MemberResolverDefault::generateMemberBody();
+            MemberResolverDefault::generateMemberBody(output);
 
             output += '\n';
 
             uniqueVector->createLocalVar(gen, "      ", dbg ? "/*unique var def*/" : "", output);
             output += uniqueVector->generateVectorReserve(gen, "      ");
 
-            output += vkgen::format(R"(
+            vkgen::format_to(std::back_inserter(output), R"(
       for ( const auto &handle : {0} )
       {{
         {1}.emplace_back(handle, {{{2}}});
       }}
 )",                 uniqueVector->original.identifier(), uniqueVector->identifier(), deleter);
 
-            return output;
+            return;
         }
 
         std::string args;
@@ -3141,7 +3164,8 @@ for (auto const &{2} : {3}) {
             // output += "      " + last->original.type() + " = " + cmd->name.original + "\n";
             const auto &id = last->identifier();
             output += "      " + last->original.type() + " " + id + ";\n";
-            output += "      " + generatePFNcall();
+            output += "      ";
+            generatePFNcall(output);
             output += "      " + generateCheck();
 
             args += id + ", {";
@@ -3159,7 +3183,6 @@ for (auto const &{2} : {3}) {
         }
 
         returnValue        = generateReturnValue(returnType + "(" + args + ")");
-        return output;
     }
 
     MemberGenerator::MemberGenerator(const Generator &gen, ClassCommand &m, GuardedOutput &decl, GuardedOutputFuncs &out, bool isStatic)
@@ -3400,6 +3423,8 @@ for (auto const &{2} : {3}) {
             return;
         }
 
+        CommandLock lock{ *m.src };
+
 //        std::cout << "    // C2: " + m.src->name + " (" + m.src->name.original + ") ";
 //        if (m.src->isIndirect()) std::cout << "INDIRECT";
 //        std::cout <<  "\n";
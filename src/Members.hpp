@@ -64,6 +64,7 @@ namespace vkgen
         const Generator                           &gen;
         const Handle                              *cls = {};
         Command                                   *cmd = {};
+        std::optional<CommandLock>                 lock;  // cmd params are rewritten while the resolver lives
         String                                     name;
         std::string                                clsname;
         std::string                                pfnSourceOverride;
@@ -133,9 +134,12 @@ namespace vkgen
 
         void reset();
 
+        bool declareResultVar();
+
         std::string declareReturnVar(const std::string &assignment = "");
 
-        virtual std::string generateMemberBody();
+        // appends method body to output
+        virtual void generateMemberBody(std::string &output);
 
         std::string castTo(const std::string &type, const std::string &src) const;
 
@@ -149,9 +153,7 @@ namespace vkgen
 
         std::string getDispatchPFN() const;
 
-        std::string generatePFNcall(bool immediateReturn = false);
-
-        std::string assignToResult(const std::string &assignment);
+        void generatePFNcall(std::string &output, bool immediateReturn = false);
 
         std::string generateReturnValue(const std::string &identifier);
 
@@ -254,9 +256,9 @@ namespace vkgen
 
         void addStdAllocators();
 
-        std::string generateDeclaration();
+        void generateDeclaration(std::string &output);
 
-        std::string generateDefinition(bool genInline, bool bypass = false);
+        void generateDefinition(std::string &output, bool genInline, bool bypass = false);
 
         bool compareSignature(const MemberResolver &o) const;
     };
@@ -280,7 +282,7 @@ namespace vkgen
 
         void generateMemberBodyArray(std::string &output, std::string &returnId, bool &returnsRAII, VariableData *vectorSizeVar, bool dbg = false);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
 
         // bool returnsResult();
 
@@ -297,7 +299,7 @@ namespace vkgen
 
         std::string temporary() const;
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverDestroy final : public MemberResolverDefault
@@ -316,7 +318,7 @@ namespace vkgen
 
         std::string temporary(const std::string &handle) const;
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
 //    class MemberResolverStaticVector final : public MemberResolverDefault
@@ -334,8 +336,10 @@ namespace vkgen
             dbgtag                  = "pass";
         }
 
-        virtual std::string generateMemberBody() override {
-            return "      " + generatePFNcall(true) + "\n";
+        virtual void generateMemberBody(std::string &output) override {
+            output += "      ";
+            generatePFNcall(output, true);
+            output += '\n';
         }
     };
 
@@ -355,8 +359,10 @@ namespace vkgen
 
         }
 
-        virtual std::string generateMemberBody() override {
-            return "      " + generatePFNcall(true) + "\n";
+        virtual void generateMemberBody(std::string &output) override {
+            output += "      ";
+            generatePFNcall(output, true);
+            output += '\n';
         }
     };
 
@@ -366,7 +372,7 @@ namespace vkgen
       public:
         MemberResolverVectorRAII(const Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverCtor : public MemberResolverDefault
@@ -409,7 +415,7 @@ namespace vkgen
 
         SuperclassSource getSuperclassSource() const;
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverInit : public MemberResolverCtor
@@ -417,7 +423,7 @@ namespace vkgen
       public:
         MemberResolverInit(const Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverVectorCtor final : public MemberResolverCtor
@@ -425,7 +431,7 @@ namespace vkgen
       public:
         MemberResolverVectorCtor(const Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverUniqueCtor final : public MemberResolverDefault
@@ -433,7 +439,7 @@ namespace vkgen
       public:
         MemberResolverUniqueCtor(Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverCreateHandleRAII final : public MemberResolverDefault
@@ -441,7 +447,7 @@ namespace vkgen
       public:
         MemberResolverCreateHandleRAII(Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverCreate : public MemberResolverDefault
@@ -449,7 +455,7 @@ namespace vkgen
       public:
         MemberResolverCreate(const Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberResolverCreateUnique final : public MemberResolverCreate
@@ -462,7 +468,7 @@ namespace vkgen
       public:
         MemberResolverCreateUnique(const Generator &gen, ClassCommand &d, MemberContext &refCtx);
 
-        std::string generateMemberBody() override;
+        void generateMemberBody(std::string &output) override;
     };
 
     class MemberGenerator
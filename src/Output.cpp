@@ -19,13 +19,33 @@
 #include "Output.hpp"
 
 #include "Generator.hpp"
+#include "SymbolTable.hpp"
+#include "Trace.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
+#include <iostream>
 #include <ostream>
+#include <utility>
+
+#ifndef _WIN32
+#    include <climits>
+#    include <fcntl.h>
+#    include <sys/uio.h>
+#    include <unistd.h>
+#endif
 
 namespace vkgen
 {
 
+    static void writeViews(std::ostream &os, const std::vector<std::string_view> &views) {
+        for (const auto &v : views) {
+            os.write(v.data(), v.size());
+        }
+    }
+
     void GuardedOutput::add(const GenericType &type, std::function<void(OutputBuffer&)> function, const std::string &guard) {
         if (!type.canGenerate()) {
             return;
@@ -79,31 +99,7 @@ namespace vkgen
         return out;
     };
 
-    void GenOutput::writeFile(Generator &gen, const std::string_view filename, const OutputBuffer &content, bool addProtect) {
-        std::string protect;
-        if (addProtect) {
-            protect = getFileNameProtect(filename, cguard);
-        }
-        std::ofstream output;
-
-        auto p = std::filesystem::path(this->path).replace_filename(filename);
-        output.open(p, std::ios::out | std::ios::trunc);
-        if (!output.is_open()) {
-            throw std::runtime_error("Can't open file: " + p.string());
-        }
-        std::filesystem::resize_file(p, content.size());
-
-        if (!protect.empty()) {
-            output << "#ifndef " << protect << "\n";
-            output << "#define " << protect;
-            if (cguard) {
-                output << " 1";
-            }
-            output << "\n\n";
-        }
-
-        output <<
-          R"(/*
+    static constexpr std::string_view fileHeader{ R"(/*
 ** Copyright 2015-2024 The Khronos Group Inc.
 **
 ** SPDX-License-Identifier: Apache-2.0
@@ -113,119 +109,289 @@ namespace vkgen
 ** This header is generated from the Khronos Vulkan XML API Registry.
 **
 */
-)";
+)" };
 
-        if (cguard) {
-            output << R"(
+    static constexpr std::string_view cguardBegin{ R"(
 #ifdef __cplusplus
 extern "C" {
 #endif
-)";
-        }
-
-        output << content;
+)" };
 
-        if (cguard) {
-            output << R"(
+    static constexpr std::string_view cguardEnd{ R"(
 #ifdef __cplusplus
 }
 #endif
-)";
+)" };
+
+    // writes all views with one gather call per batch instead of copying them into a stream
+    static bool writeViews(const std::filesystem::path &path, const std::vector<std::string_view> &views) {
+#ifdef _WIN32
+        std::ofstream output{ path, std::ios::out | std::ios::binary | std::ios::trunc };
+        if (!output.is_open()) {
+            return false;
+        }
+        writeViews(output, views);
+        return output.good();
+#else
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        std::vector<iovec> iov;
+        iov.reserve(std::min<size_t>(views.size(), IOV_MAX));
+        auto it = views.begin();
+        while (it != views.end()) {
+            iov.clear();
+            size_t bytes = 0;
+            for (; it != views.end() && iov.size() < IOV_MAX; ++it) {
+                if (!it->empty()) {
+                    iov.push_back(iovec{ const_cast<char *>(it->data()), it->size() });
+                    bytes += it->size();
+                }
+            }
+            // writev may stop early, continue from the first unwritten byte
+            size_t index = 0;
+            while (bytes > 0) {
+                const ssize_t written = ::writev(fd, iov.data() + index, static_cast<int>(iov.size() - index));
+                if (written < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (written <= 0) {
+                    ::close(fd);
+                    return false;
+                }
+                bytes -= written;
+                size_t remaining = written;
+                while (index < iov.size() && remaining >= iov[index].iov_len) {
+                    remaining -= iov[index].iov_len;
+                    index++;
+                }
+                if (remaining > 0) {
+                    iov[index].iov_base = static_cast<char *>(iov[index].iov_base) + remaining;
+                    iov[index].iov_len -= remaining;
+                }
+            }
+        }
+        return ::close(fd) == 0;
+#endif
+    }
+
+    void GenOutput::writeFile(Generator &gen, const std::string_view filename, const OutputBuffer &content, bool addProtect) {
+        Trace::Scope trace{ [&] { return "writeFile " + std::string{ filename }; } };
+        if (gen.isPrintOutputStats()) {
+            std::cout << filename << '\n';
+            content.print();
+        }
+        std::string protect;
+        if (addProtect) {
+            protect = getFileNameProtect(filename, cguard);
         }
 
+        std::string head;
+        std::string tail;
         if (!protect.empty()) {
-            output << "#endif // " + protect + "\n";
+            head += "#ifndef " + protect + "\n";
+            head += "#define " + protect;
+            if (cguard) {
+                head += " 1";
+            }
+            head += "\n\n";
+            tail = "#endif // " + protect + "\n";
+        }
+
+        std::vector<std::string_view> views;
+        views.emplace_back(head);
+        views.emplace_back(fileHeader);
+        if (cguard) {
+            views.emplace_back(cguardBegin);
+        }
+        content.gather(views);
+        if (cguard) {
+            views.emplace_back(cguardEnd);
+        }
+        views.emplace_back(tail);
+
+        size_t   size = 0;
+        uint64_t hash = fnv1aBasis;
+        for (const auto &v : views) {
+            size += v.size();
+            hash = hashFnv1a(v, hash);
+        }
+
+        const auto p = std::filesystem::path(this->path).replace_filename(filename);
+
+        std::error_code ec;
+        if (std::filesystem::file_size(p, ec) == size && !ec && GenerationCache::hashFile(p) == hash) {
+            gen.countOutputFile(false);
+            return;
         }
 
-        // std::cout << "Generated: " << p << ", reserved: " << content.size() << "B\n";
+        auto tmp = p;
+        tmp += ".tmp";
+        if (!writeViews(tmp, views)) {
+            std::filesystem::remove(tmp, ec);
+            throw std::runtime_error("Can't write file: " + tmp.string());
+        }
+        std::filesystem::rename(tmp, p);
+        gen.countOutputFile(true);
     }
 
-    GuardedOutput::GuardedOutput() {
-        output = std::make_unique<OutputBuffer>();
+    uint32_t GuardedOutput::segment(const uint32_t parent, const uint32_t protect, const bool ifdef) {
+        for (uint32_t i = 0; i < segments.size(); ++i) {
+            auto &s = segments[i];
+            if (s.parent == parent && s.protect == protect) {
+                s.ifdef = ifdef;
+                return i;
+            }
+        }
+        segments.push_back(Segment{ .parent = parent, .protect = protect, .ifdef = ifdef });
+        return static_cast<uint32_t>(segments.size() - 1);
     }
 
     void GuardedOutput::clear() {
-        if (output) {
-            output->clear();
-        }
-        else {
-            output = std::make_unique<OutputBuffer>();
-        }
+        output.clear();
         segments.clear();
     }
 
     size_t GuardedOutput::size() const {
-        size_t s = 0;
-        if (output) {
-            s += output->size();
-        }
+        size_t s = output.size();
         for (const auto &k : segments) {
-            s += k.second.size();
+            s += k.output.size();
         }
         return s;
     }
 
     std::string GuardedOutput::toString() const {
-        std::stringstream s;
-        write(s);
-        return s.str();
+        std::vector<std::string_view> views;
+        gather(views);
+        size_t size = 0;
+        for (const auto &v : views) {
+            size += v.size();
+        }
+        std::string str;
+        str.reserve(size);
+        for (const auto &v : views) {
+            str += v;
+        }
+        return str;
     }
 
     OutputBuffer &GuardedOutput::get(const std::span<Protect> protects) {
-        GuardedOutput *output = this;
+        uint32_t index = root;
         for (const auto &p : protects) {
             if (!p.first.empty()) {
-                output = &output->get(p.first, p.second);
+                index = segment(index, SymbolTable::global().intern(p.first), p.second);
             }
         }
-        return output->get();
+        return buffer(index);
     }
 
-    void GuardedOutput::write(std::ostream &os) const {
-        os << *output;
+    void GuardedOutput::merge(GuardedOutput &&other) {
+        output += std::move(other.output);
+        // parents always precede their children
+        std::vector<uint32_t> indices(other.segments.size());
+        for (uint32_t i = 0; i < other.segments.size(); ++i) {
+            auto      &s      = other.segments[i];
+            const auto parent = s.parent == root ? root : indices[s.parent];
+            indices[i]        = segment(parent, s.protect, s.ifdef);
+            segments[indices[i]].output += std::move(s.output);
+        }
+    }
+
+    void GuardedOutput::collectStats(OutputStats &stats) const {
+        output.collectStats(stats);
         for (const auto &s : segments) {
-            if (s.second.ifdef) {
-                os << "#ifdef ";
-            } else {
-                os << "#ifndef ";
+            s.output.collectStats(stats);
+        }
+    }
+
+    void GuardedOutput::gatherSegments(const uint32_t parent, std::vector<std::string_view> &views) const {
+        auto &symbols = SymbolTable::global();
+
+        std::vector<std::pair<std::string_view, uint32_t>> children;
+        for (uint32_t i = 0; i < segments.size(); ++i) {
+            if (segments[i].parent == parent) {
+                children.emplace_back(symbols[segments[i].protect], i);
             }
-            os << s.first << '\n';
-            s.second.write(os);
-            os << "#endif // " << s.first << '\n';
+        }
+        std::sort(children.begin(), children.end());
+
+        for (const auto &[protect, i] : children) {
+            views.emplace_back(segments[i].ifdef ? "#ifdef " : "#ifndef ");
+            views.emplace_back(protect);
+            views.emplace_back("\n");
+            segments[i].output.gather(views);
+            gatherSegments(i, views);
+            views.emplace_back("#endif // ");
+            views.emplace_back(protect);
+            views.emplace_back("\n");
         }
     }
 
-    std::ostream &operator<<(std::ostream &os, const vkgen::OutputClass &c) {
-        os << "  class " << c.name;
-        if (!c.inherits.empty()) {
-            os << " : " << c.inherits;
+    void GuardedOutput::gather(std::vector<std::string_view> &views) const {
+        output.gather(views);
+        gatherSegments(root, views);
+    }
+
+    void GuardedOutput::write(std::ostream &os) const {
+        std::vector<std::string_view> views;
+        gather(views);
+        writeViews(os, views);
+    }
+
+    void OutputClass::gather(std::vector<std::string_view> &views) const {
+        views.emplace_back("  class ");
+        views.emplace_back(name);
+        if (!inherits.empty()) {
+            views.emplace_back(" : ");
+            views.emplace_back(inherits);
         }
-        os << " {\n";
+        views.emplace_back(" {\n");
 
-        const auto addSection = [&](const std::string &visibility, const GuardedOutput &segment) {
+        const auto addSection = [&](const std::string_view visibility, const GuardedOutput &segment) {
             if (segment.size() > 0) {
-                if (!visibility.empty()) {
-                    os << "  " + visibility + ":\n";
-                }
-                os << segment;
+                views.emplace_back(visibility);
+                segment.gather(views);
             }
         };
 
-        addSection("public", c.sPublic);
-        addSection("", c.sFuncs);
-        addSection("private", c.sPrivate);
-        addSection("protected", c.sProtected);
-        os << "  };\n";
+        addSection("  public:\n", sPublic);
+        addSection("", sFuncs);
+        addSection("  private:\n", sPrivate);
+        addSection("  protected:\n", sProtected);
+        views.emplace_back("  };\n");
+    }
 
+    std::ostream &operator<<(std::ostream &os, const vkgen::OutputClass &c) {
+        std::vector<std::string_view> views;
+        c.gather(views);
+        writeViews(os, views);
         return os;
     }
 
-    OutputBuffer::OutputBuffer() {
-        this->operator+=(std::string_view{}); // sentinel
-    }
+    OutputBuffer::OutputBuffer() = default;
 
     OutputBuffer::OutputBuffer(std::string &&str) {
-        list.emplace_back(UnmutableString{ std::move(str) });
+        copy(str);
+    }
+
+    OutputBuffer::OutputBuffer(OutputBuffer &&other) noexcept {
+        *this = std::move(other);
+    }
+
+    OutputBuffer &OutputBuffer::operator=(OutputBuffer &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        fragments  = std::exchange(other.fragments, {});
+        nested     = std::exchange(other.nested, {});
+        blocks     = std::exchange(other.blocks, {});
+        tail       = std::exchange(other.tail, nullptr);
+        available  = std::exchange(other.available, 0);
+        reserved   = std::exchange(other.reserved, 0);
+        references = std::exchange(other.references, 0);
+        m_size     = std::exchange(other.m_size, 0);
+        return *this;
     }
 
     size_t OutputBuffer::size() const {
@@ -233,82 +399,172 @@ extern "C" {
     }
 
     void OutputBuffer::clear() {
-        list.clear();
+        fragments.clear();
+        nested.clear();
+        blocks.clear();
+        tail      = nullptr;
+        available  = 0;
+        reserved   = 0;
+        references = 0;
+        m_size     = 0;
     }
 
-//    std::string &OutputBuffer::emplace() {
-//        auto &s = list.emplace_back(std::string{});
-//        return std::get<std::string>(s);
-//    }
+    void OutputBuffer::copy(const std::string_view str) {
+        if (str.empty()) {
+            return;
+        }
+        if (str.size() > available) {
+            // blocks grow with the buffer, so small nested buffers stay small
+            const size_t blockSize = std::max(std::clamp(reserved, minBlockSize, maxBlockSize), str.size());
+            tail      = blocks.emplace_back(std::make_unique_for_overwrite<char[]>(blockSize)).get();
+            available = blockSize;
+            reserved += blockSize;
+        }
+        std::memcpy(tail, str.data(), str.size());
+
+        // extend previous fragment if it ends where the copy starts
+        if (!fragments.empty()) {
+            auto &last = fragments.back();
+            if (last.nested == npos && last.text.data() + last.text.size() == tail) {
+                last.text = std::string_view{ last.text.data(), last.text.size() + str.size() };
+                tail += str.size();
+                available -= str.size();
+                m_size += str.size();
+                return;
+            }
+        }
+        fragments.push_back(Fragment{ .text = std::string_view{ tail, str.size() } });
+        tail += str.size();
+        available -= str.size();
+        m_size += str.size();
+    }
+
+    void OutputBuffer::reference(const std::string_view str) {
+        if (str.empty()) {
+            return;
+        }
+        fragments.push_back(Fragment{ .text = str });
+        references++;
+        m_size += str.size();
+    }
+
+    void OutputBuffer::addNested(Nested &&value, size_t size) {
+        fragments.push_back(Fragment{ .nested = nested.size() });
+        nested.push_back(std::move(value));
+        m_size += size;
+    }
+
+    void OutputBuffer::collectStats(OutputStats &stats) const {
+        for (const auto &f : fragments) {
+            if (f.nested != npos) {
+                continue;
+            }
+            stats.fragments++;
+        }
+        stats.references += references;
+        stats.allocations += blocks.size();
+        stats.reserved += reserved;
+        stats.nested += nested.size();
+        for (const auto &n : nested) {
+            std::visit(
+              [&](auto &&arg) {
+                  using T = std::decay_t<decltype(arg)>;
+                  if constexpr (std::is_same_v<T, OutputClass>) {
+                      arg.sFuncs.collectStats(stats);
+                      arg.sPublic.collectStats(stats);
+                      arg.sPrivate.collectStats(stats);
+                      arg.sProtected.collectStats(stats);
+                  } else {
+                      arg.collectStats(stats);
+                  }
+              },
+              n);
+        }
+    }
 
     void OutputBuffer::print() const {
+        OutputStats stats;
+        collectStats(stats);
         std::cout << "-- Out buffer {" << std::endl;
-        for (const auto &l : list) {
-            std::cout << "<" << l.index() << ">";
-            std::visit([&](auto &&arg) { std::cout << ", " << arg.size() << "B"; }, l);
-            std::cout << std::endl;
-        }
+        std::cout << "  size: " << size() << "B" << std::endl;
+        std::cout << "  fragments: " << stats.fragments << " (" << stats.references << " references)" << std::endl;
+        std::cout << "  allocations: " << stats.allocations << " (" << stats.reserved << "B reserved)" << std::endl;
+        std::cout << "  nested: " << stats.nested << std::endl;
         std::cout << "}" << std::endl;
-
-        //    std::string output;
-        //    for (const auto &l : list) {
-        //        output += l;
-        //    }
-        //    std::cout << output << std::endl;
     }
 
     OutputBuffer &OutputBuffer::operator+=(const std::string_view str) {
-        list.emplace_back(std::string_view{ str });
-        m_size += str.size();
+        reference(str);
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(std::string &&str) {
-        m_size += str.size();
-        list.emplace_back(vkgen::UnmutableString{ std::move(str) });
+        copy(str);
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(const std::string &str) {
-        if (list.rbegin()->index() == 0) {
-            std::get<std::string>(*list.rbegin()) += str;
-            m_size += str.size();
-        } else {
-            list.emplace_back(std::string{ str });
-            m_size += str.size();
-        }
+        copy(str);
+        return *this;
+    }
+
+    OutputBuffer &OutputBuffer::append(const std::string_view str) {
+        copy(str);
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(const char * const str) {
-        const auto &s = std::string::traits_type::length(str);
-        list.emplace_back(std::string_view{ str, s });
-        m_size += s;
+        reference(std::string_view{ str });
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(OutputBuffer &&out) {
-        m_size += out.size();
-        list.emplace_back(std::move(out));
+        const size_t size = out.size();
+        addNested(std::move(out), size);
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(GuardedOutput &&out) {
-        m_size += out.size();
-        list.emplace_back(std::move(out));
+        const size_t size = out.size();
+        addNested(std::move(out), size);
         return *this;
     }
 
     OutputBuffer &OutputBuffer::operator+=(OutputClass &&out) {
-        m_size += out.size();
-        list.emplace_back(std::move(out));
+        const size_t size = out.size();
+        addNested(std::move(out), size);
         return *this;
     }
 
-    std::ostream &operator<<(std::ostream &os, const vkgen::OutputBuffer &s) {
-        for (const auto &l : s.list) {
-            std::visit([&](auto &&arg) { os << arg; }, l);
+    void OutputBuffer::gather(std::vector<std::string_view> &views) const {
+        for (const auto &f : fragments) {
+            if (f.nested == npos) {
+                views.emplace_back(f.text);
+            } else {
+                std::visit([&](auto &&arg) { arg.gather(views); }, nested[f.nested]);
+            }
+        }
+    }
+
+    std::string ItemOutput::toString() const {
+        std::vector<std::string_view> views;
+        output.gather(views);
+        forward.gather(views);
+        funcs.decl.gather(views);
+        funcs.def.gather(views);
+        funcs.templ.gather(views);
+        funcs.platform.gather(views);
+        std::string str;
+        for (const auto &v : views) {
+            str += v;
         }
+        return str;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const vkgen::OutputBuffer &s) {
+        std::vector<std::string_view> views;
+        s.gather(views);
+        writeViews(os, views);
         return os;
     }
 
@@ -19,48 +19,155 @@
 #ifndef GENERATOR_OUTPUT_HPP
 #define GENERATOR_OUTPUT_HPP
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
-#include <list>
 #include <map>
+#include <memory>
 #include <span>
+#include <string_view>
 #include <variant>
+#include <vector>
 
 namespace vkgen
 {
     struct GenericType;
-    class OutputBuffer;
+    class GuardedOutput;
     class Generator;
+    struct OutputClass;
 
     using Protect = std::pair<std::string, bool>;
 
+    // counters for OutputBuffer::print
+    struct OutputStats
+    {
+        size_t fragments   = {};  // text pieces, copied or referenced
+        size_t references  = {};  // fragments pointing to text owned elsewhere (RES_* templates, literals)
+        size_t allocations = {};  // arena blocks
+        size_t reserved    = {};  // bytes reserved in arena blocks
+        size_t nested      = {};  // nested buffers, guarded outputs and classes
+    };
+
+    // Rope of text fragments. Copied text is packed into large arena blocks,
+    // string_view and literal appends are kept as references without copying.
+    class OutputBuffer
+    {
+        using Nested = std::variant<OutputBuffer, GuardedOutput, OutputClass>;
+
+        struct Fragment
+        {
+            std::string_view text;
+            size_t           nested = npos;
+        };
+
+        static constexpr size_t npos         = size_t(-1);
+        static constexpr size_t minBlockSize = 256;
+        static constexpr size_t maxBlockSize = 64 * 1024;
+
+        std::vector<Fragment>                fragments;
+        std::vector<Nested>                  nested;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char                                *tail       = {};
+        size_t                               available  = {};
+        size_t                               reserved   = {};
+        size_t                               references = {};
+        size_t                               m_size     = {};
+
+        void copy(std::string_view str);
+
+        void reference(std::string_view str);
+
+        void addNested(Nested &&value, size_t size);
+
+      public:
+        OutputBuffer();
+
+        OutputBuffer(std::string &&str);
+
+        OutputBuffer(OutputBuffer &&other) noexcept;
+
+        OutputBuffer &operator=(OutputBuffer &&other) noexcept;
+
+        size_t size() const;
+
+        void clear();
+
+        OutputBuffer &operator+=(std::string_view str);
+
+        OutputBuffer &operator+=(std::string &&str);
+
+        OutputBuffer &operator+=(const std::string &str);
+
+        OutputBuffer &operator+=(const char *str);
+
+        OutputBuffer &operator+=(OutputBuffer &&);
+
+        OutputBuffer &operator+=(GuardedOutput &&);
+
+        OutputBuffer &operator+=(OutputClass &&);
+
+        // copies text into the arena, unlike operator+=(std::string_view)
+        OutputBuffer &append(std::string_view str);
+
+        // appends views of all fragments, nested outputs included
+        void gather(std::vector<std::string_view> &views) const;
+
+        void collectStats(OutputStats &stats) const;
+
+        // prints size and fragment/allocation counts, nested buffers included
+        void print() const;
+
+        friend std::ostream & operator<<(std::ostream&, const OutputBuffer&);
+    };
+
+    std::ostream &operator<<(std::ostream &os, const OutputBuffer &s);
+
+    // Output split into segments guarded by protect macros (#ifdef / #ifndef).
+    // Segments of all nesting levels are kept in one flat vector, identified by parent segment and interned protect id.
+    // Sibling segments are written sorted by protect name.
     class GuardedOutput
     {
-        std::unique_ptr<OutputBuffer>                   output;
-        std::map<std::string, GuardedOutput> segments;
-        bool                                            ifdef = {};
-
-        GuardedOutput &get(const std::string &protect, bool ifdef) {
-            auto &s = segments[protect];
-            s.ifdef = ifdef;
-            return s;
+        friend class GenerationCache;
+
+        static constexpr uint32_t root = uint32_t(-1);
+
+        struct Segment
+        {
+            uint32_t     parent  = root;
+            uint32_t     protect = {};  // SymbolTable::global() id
+            bool         ifdef   = {};
+            OutputBuffer output;
+        };
+
+        OutputBuffer         output;
+        std::vector<Segment> segments;
+
+        // finds or creates child segment of parent, references into segments are invalidated on creation
+        uint32_t segment(uint32_t parent, uint32_t protect, bool ifdef);
+
+        OutputBuffer &buffer(uint32_t index) {
+            return index == root ? output : segments[index].output;
         }
 
-      public:
-        GuardedOutput();
+        void gatherSegments(uint32_t parent, std::vector<std::string_view> &views) const;
 
+      public:
         OutputBuffer &operator*() {
-            return *output;
+            return output;
         }
 
         template <typename T>
         GuardedOutput &operator+=(T &&v) {
-            *output += std::forward<T>(v);
+            output += std::forward<T>(v);
             return *this;
         }
 
         size_t size() const;
 
+        bool empty() const {
+            return output.size() == 0 && segments.empty();
+        }
+
         void clear();
 
         // void add(const GenericType &type, std::function<void(std::string &)> function, const std::string &guard = "");
@@ -68,14 +175,23 @@ namespace vkgen
         void add(const GenericType &type, std::function<void(OutputBuffer &)> function, const std::string &guard = "");
 
         OutputBuffer &get() {
-            return *output;
+            return output;
         }
 
+        // returned buffer is valid until next get() call that creates a segment
         OutputBuffer &get(std::span<Protect> protects);
 
+        // appends other's content to this output and to matching protect segments
+        void merge(GuardedOutput &&other);
+
+        // appends views of the rendered text, valid while this output is alive
+        void gather(std::vector<std::string_view> &views) const;
+
         void write(std::ostream &os) const;
 
         std::string toString() const;
+
+        void collectStats(OutputStats &stats) const;
     };
 
     struct GuardedOutputFuncs
@@ -92,6 +208,13 @@ namespace vkgen
             platform.clear();
         }
 
+        void merge(GuardedOutputFuncs &&other) {
+            decl.merge(std::move(other.decl));
+            def.merge(std::move(other.def));
+            templ.merge(std::move(other.templ));
+            platform.merge(std::move(other.platform));
+        }
+
     };
 
     inline std::ostream &operator<<(std::ostream &os, const vkgen::GuardedOutput &s) {
@@ -128,49 +251,23 @@ namespace vkgen
             return name.size() + sFuncs.size() + sPublic.size() + sPrivate.size() + sProtected.size();
         }
 
+        void gather(std::vector<std::string_view> &views) const;
+
         friend std::ostream & operator<<(std::ostream&, const OutputClass&);
     };
 
     std::ostream &operator<<(std::ostream &os, const vkgen::OutputClass &s);
 
-    class OutputBuffer
+    // output of one registry item, spliced back in registry order
+    struct ItemOutput
     {
-        using Segment = std::variant<std::string, std::string_view, OutputBuffer, GuardedOutput, OutputClass>;
-        std::list<Segment> list;
-        size_t             m_size = {};
-
-      public:
-        OutputBuffer();
-
-        OutputBuffer(std::string &&str);
-
-        size_t size() const;
+        OutputBuffer       output;
+        OutputBuffer       forward;
+        GuardedOutputFuncs funcs;
 
-        void clear();
-
-        // std::string &emplace();  // deprecate
-
-        OutputBuffer &operator+=(std::string_view str);
-
-        OutputBuffer &operator+=(std::string &&str);
-
-        OutputBuffer &operator+=(const std::string &str);
-
-        OutputBuffer &operator+=(const char *str);
-
-        OutputBuffer &operator+=(OutputBuffer &&);
-
-        OutputBuffer &operator+=(GuardedOutput &&);
-
-        OutputBuffer &operator+=(OutputClass &&);
-
-        void print() const;
-
-        friend std::ostream & operator<<(std::ostream&, const OutputBuffer&);
+        std::string toString() const;
     };
 
-    std::ostream &operator<<(std::ostream &os, const OutputBuffer &s);
-
     struct OutputFile
     {
         OutputBuffer content;
@@ -228,6 +325,7 @@ namespace vkgen
 
         void writeFile(Generator &gen, OutputFile &file);
 
+        // file is replaced through a temporary file only when its content changed
         void writeFile(Generator &gen, const std::string_view filename, const OutputBuffer &content, bool addProtect = true);
 
         static std::string getFileNameProtect(const std::string_view name, bool cguard);
@@ -0,0 +1,92 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_PARALLEL_HPP
+#define GENERATOR_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vkgen
+{
+
+    // number of workers for jobs == 0
+    inline size_t hardwareJobs() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Calls func for every index in [0, count) on up to jobs threads, the calling thread included.
+    // Workers claim the next free index, so threads that finish cheap items pick up the remaining work.
+    // The first exception thrown by func is rethrown after all workers have stopped.
+    inline void parallelFor(size_t count, size_t jobs, const std::function<void(size_t)> &func) {
+        if (jobs == 0) {
+            jobs = hardwareJobs();
+        }
+        jobs = std::min(jobs, count);
+        if (jobs <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                func(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next   = 0;
+        std::atomic<bool>   failed = false;
+        std::exception_ptr  error;
+        std::mutex          errorMutex;
+
+        const auto worker = [&] {
+            while (!failed) {
+                const size_t i = next++;
+                if (i >= count) {
+                    return;
+                }
+                try {
+                    func(i);
+                } catch (...) {
+                    std::lock_guard lock{ errorMutex };
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(jobs - 1);
+        for (size_t i = 1; i < jobs; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto &t : threads) {
+            t.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_PARALLEL_HPP
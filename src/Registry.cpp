@@ -20,9 +20,14 @@
 
 #include "Generator.hpp"
 #include "Format.hpp"
+#include "Trace.hpp"
 
+#include <chrono>
 #include <filesystem>
+#include <future>
+#include <map>
 #include <ranges>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <string>
@@ -191,11 +196,11 @@ namespace vkgen
         const std::string suffix = strRemoveTag(str);
         std::string       out    = convertSnakeToCamel(str);
 
-        out = std::regex_replace(out, std::regex("bit"), "Bit");
-        out = std::regex_replace(out, std::regex("Rgba10x6"), "Rgba10X6");
-        out = std::regex_replace(out, std::regex("1d"), "1D");
-        out = std::regex_replace(out, std::regex("2d"), "2D");
-        out = std::regex_replace(out, std::regex("3d"), "3D");
+        out = strReplaceAll(std::move(out), "bit", "Bit");
+        out = strReplaceAll(std::move(out), "Rgba10x6", "Rgba10X6");
+        out = strReplaceAll(std::move(out), "1d", "1D");
+        out = strReplaceAll(std::move(out), "2d", "2D");
+        out = strReplaceAll(std::move(out), "3d", "3D");
         if (out.size() >= 2) {
             for (int i = 0; i < out.size() - 1; i++) {
                 const char &c    = out[i];
@@ -295,7 +300,7 @@ namespace vkgen
         // iterate contents of <platforms>, filter only <platform> children
         for (const auto &platform : xml::vulkanElements(children, "platform")) {
             auto name    = platform["name"];
-            auto protect = platform["protect"];
+            auto protect = SymbolTable::global().view(platform["protect"]);
             auto &p   = platforms.items.emplace_back(name, protect, defaultWhitelistOption);
             p.version = no_ver;
         }
@@ -471,7 +476,7 @@ namespace vkgen
             apiConstants.emplace_back(*this, name, value, type);
         }
 
-        static const auto find = [&](const std::string &name) {
+        const auto find = [&](const std::string &name) {
             for (const auto &e : apiConstants) {
                 if (e.name.original == name) {
                     return e;
@@ -552,6 +557,8 @@ namespace vkgen
     }
 
     void Registry::orderCommands() {
+        Trace::Scope trace{ "orderCommands" };
+
         std::sort(commands.ordered.begin(), commands.ordered.end(), [](const Command &a, const Command &b){ return a.successCodes.size() < b.successCodes.size(); });
 
         return;
@@ -605,6 +612,8 @@ namespace vkgen
     }
 
     void Registry::assignCommands(Generator &gen) {
+        Trace::Scope trace{ "assignCommands" };
+
         if (handles.items.empty()) {
             return;
         }
@@ -764,6 +773,31 @@ namespace vkgen
             std::cout << "Assign commands done" << '\n';
     }
 
+    std::string Registry::toFlagsName(const std::string &name) const {
+        auto it = flagBitsToFlags.find(name);
+        if (it != flagBitsToFlags.end()) {
+            return it->second;
+        }
+        return Enum::toFlags(name);
+    }
+
+    std::string Registry::toFlagBitsName(const std::string &name) const {
+        auto it = flagsToFlagBits.find(name);
+        if (it != flagsToFlagBits.end()) {
+            return it->second;
+        }
+        return Enum::toFlagBits(name);
+    }
+
+    const std::vector<GenericType *> &Registry::getTypeUsers(const std::string &type) const {
+        static const std::vector<GenericType *> empty;
+        auto it = typeUsers.find(type);
+        if (it == typeUsers.end()) {
+            return empty;
+        }
+        return it->second;
+    }
+
     GenericType &Registry::get(const std::string &name) {
         assert(!types.empty() && "type map not build yet\n");
 
@@ -801,7 +835,149 @@ namespace vkgen
         return nullptr;
     }
 
+    void Registry::setEnabledBatch(const std::vector<GenericType *> &roots) {
+        // dense graph of every type reachable from containers
+        std::vector<GenericType *>                   nodes;
+        std::unordered_map<GenericType *, uint32_t>  ids;
+        std::vector<std::vector<uint32_t>>           deps;
+
+        const auto getId = [&](GenericType *type) {
+            auto [it, inserted] = ids.emplace(type, static_cast<uint32_t>(nodes.size()));
+            if (inserted) {
+                nodes.push_back(type);
+            }
+            return it->second;
+        };
+        const auto addNodes = [&](auto &container) {
+            for (auto &i : container.items) {
+                getId(&i);
+            }
+        };
+        addNodes(platforms);
+        addNodes(extensions);
+        addNodes(features);
+        addNodes(enums);
+        addNodes(structs);
+        addNodes(handles);
+        addNodes(commands);
+
+        // nodes grows while walking, dependencies of new nodes are visited as well
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            std::vector<uint32_t> d;
+            d.reserve(nodes[i]->dependencies.size());
+            for (auto *dep : nodes[i]->dependencies) {
+                d.push_back(getId(dep));
+            }
+            deps.emplace_back(std::move(d));
+        }
+
+        const size_t          words = (nodes.size() + 63) / 64;
+        std::vector<uint64_t> enabled(words);
+        const auto test = [&](const std::vector<uint64_t> &bits, uint32_t id) {
+            return (bits[id / 64] >> (id % 64)) & 1;
+        };
+        const auto set = [&](std::vector<uint64_t> &bits, uint32_t id) {
+            bits[id / 64] |= uint64_t{ 1 } << (id % 64);
+        };
+
+        // closure, unsupported types are never enabled and do not pull their dependencies
+        std::vector<uint32_t> stack;
+        for (auto *r : roots) {
+            auto it = ids.find(r);
+            if (it != ids.end() && r->isSupported() && !test(enabled, it->second)) {
+                set(enabled, it->second);
+                stack.push_back(it->second);
+            }
+        }
+        while (!stack.empty()) {
+            const auto id = stack.back();
+            stack.pop_back();
+            for (auto d : deps[id]) {
+                if (nodes[d]->isSupported() && !test(enabled, d)) {
+                    set(enabled, d);
+                    stack.push_back(d);
+                }
+            }
+        }
+
+        // materialize state, subscribers from types outside of graph are kept
+        for (auto *n : nodes) {
+            n->setEnabledState(false);
+            std::erase_if(n->subscribers, [&](GenericType *s) { return ids.contains(s); });
+        }
+        size_t count = 0;
+        for (uint32_t id = 0; id < nodes.size(); ++id) {
+            if (!test(enabled, id)) {
+                continue;
+            }
+            auto *node = nodes[id];
+            node->setEnabledState(true);
+            count++;
+            for (auto d : deps[id]) {
+                // mutually dependent types subscribe only in one direction, like setEnabled does
+                if (d != id && d < id && test(enabled, d)) {
+                    const auto &back = deps[d];
+                    if (std::find(back.begin(), back.end(), id) != back.end()) {
+                        continue;
+                    }
+                }
+                nodes[d]->subscribers.insert(node);
+            }
+        }
+        if (verbose) {
+            std::cout << "batch enable: " << count << " of " << nodes.size() << " types enabled\n";
+        }
+    }
+
+    std::vector<Registry::TypeState> Registry::saveTypeStates() {
+        std::vector<TypeState>            states;
+        std::unordered_set<GenericType *> visited;
+        const auto add = [&](GenericType *type) {
+            if (visited.insert(type).second) {
+                states.push_back(TypeState{ type, type->isEnabled(), type->subscribers });
+                return true;
+            }
+            return false;
+        };
+        const auto addItems = [&](auto &container) {
+            for (auto &i : container.items) {
+                add(&i);
+            }
+        };
+        addItems(platforms);
+        addItems(extensions);
+        addItems(features);
+        addItems(enums);
+        for (auto &s : structs.items) {
+            if (add(&s)) {
+                for (const auto &m : s.members) {
+                    states.back().members.emplace_back(m.get(), m->getSpecialType());
+                }
+            }
+        }
+        addItems(handles);
+        addItems(commands);
+        for (size_t i = 0; i < states.size(); ++i) {
+            for (auto *dep : states[i].type->dependencies) {
+                add(dep);
+            }
+        }
+        return states;
+    }
+
+    void Registry::restoreTypeStates(const std::vector<TypeState> &states) {
+        for (const auto &s : states) {
+            s.type->setEnabledState(s.enabled);
+            s.type->subscribers = s.subscribers;
+            for (const auto &[var, type] : s.members) {
+                var->setSpecialType(type);
+            }
+        }
+    }
+
     void Registry::orderStructs() {
+        Trace::Scope trace{ "orderStructs" };
+
         DependencySorter<Struct> sorter;
 
         sorter.sort(structs, "structs", [&](DependencySorter<Struct>::Item &i) {
@@ -815,6 +991,8 @@ namespace vkgen
     }
 
     void Registry::orderHandles() {
+        Trace::Scope trace{ "orderHandles" };
+
         DependencySorter<Handle> sorter;
         const auto               filter = [&](DependencySorter<Handle>::Item &i, ClassCommand &m) {
             std::string_view                        name = m.name.original;
@@ -937,8 +1115,27 @@ namespace vkgen
     }
 
     void Registry::buildTypesMap() {
+        Trace::Scope trace{ "buildTypesMap" };
+
         types.clear();
         aliases.clear();
+        flagBitsToFlags.clear();
+        flagsToFlagBits.clear();
+
+        const auto addFlagNames = [&](const std::string &flags, const std::string &flagBits) {
+            flagBitsToFlags.emplace(flagBits, flags);
+            flagsToFlagBits.emplace(flags, flagBits);
+        };
+        for (const auto &e : enums) {
+            if (e.isBitmask()) {
+                addFlagNames(e.name.original, e.bitmask.original);
+                addFlagNames(e.name, e.bitmask);
+            }
+            for (const auto &a : e.aliases) {
+                addFlagNames(Enum::toFlags(a.name.original), Enum::toFlagBits(a.name.original));
+                addFlagNames(Enum::toFlags(a.name), Enum::toFlagBits(a.name));
+            }
+        }
 
         handles.addTypes(types);
         enums.addTypes(types);
@@ -971,6 +1168,8 @@ namespace vkgen
     }
 
     void Registry::removeUnsupportedFeatures() {
+        Trace::Scope trace{ "removeUnsupportedFeatures" };
+
 
         const auto disableType = [](GenericType *type) {
             if (!type) {
@@ -1011,15 +1210,11 @@ namespace vkgen
                 //        }
 
                 if (name.value().find("FlagBits") != std::string::npos) {
-                    std::string tmp = std::string{ name.value() };
-                    tmp             = std::regex_replace(tmp, std::regex("FlagBits"), "Flags");
-                    auto *type      = find(tmp);
+                    auto *type = find(toFlagsName(std::string{ name.value() }));
                     disableType(type);
                 }
                 if (name.value().find("Flags") != std::string::npos) {
-                    std::string tmp = std::string{ name.value() };
-                    tmp             = std::regex_replace(tmp, std::regex("Flags"), "FlagBits");
-                    auto *type      = find(tmp);
+                    auto *type = find(toFlagBitsName(std::string{ name.value() }));
                     disableType(type);
                 }
             }
@@ -1094,7 +1289,7 @@ namespace vkgen
             const auto number = elem["number"];
 
             auto &feature = features.items.emplace_back(name);
-            feature.version = number.data();
+            feature.version = SymbolTable::global().c_str(number);
 
             for (const auto &require : xml::elements(elem.firstChild(), "require")) {
                 assignVersions(require, &feature, nullptr);
@@ -1120,6 +1315,8 @@ namespace vkgen
             if (number) {
                 ext.number = toInt(std::string(number.value()));
             }
+            const auto type = elem.optional("type");
+            ext.device      = type && type.value() == "device";
             const auto comment = elem.optional("comment");
             if (comment) {
                 ext.comment = comment.value();
@@ -1227,6 +1424,8 @@ namespace vkgen
     }
 
     void Registry::buildDependencies(Generator &gen) {
+        Trace::Scope trace{ "buildDependencies" };
+
         if (verbose)
             std::cout << "Building dependencies information" << '\n';
 
@@ -1255,6 +1454,14 @@ namespace vkgen
             }
         }
 
+        const auto addTypeUser = [&](const std::string &type, GenericType &user) {
+            auto &users = typeUsers[type];
+            if (users.empty() || users.back() != &user) {
+                users.push_back(&user);
+            }
+        };
+
+        typeUsers.clear();
         for (auto &s : structs) {
             for (auto &a : s.aliases) {
                 a.parentExtension = s.getExtension();
@@ -1266,6 +1473,7 @@ namespace vkgen
                 if (d) {
                     s.dependencies.insert(d);
                 }
+                addTypeUser(type, s);
             }
         }
 
@@ -1280,6 +1488,7 @@ namespace vkgen
                 if (d) {
                     command.dependencies.insert(d);
                 }
+                addTypeUser(type, command);
             }
             command.init(*this);
         }
@@ -1298,8 +1507,6 @@ namespace vkgen
     }
 
     bool Registry::load(Generator &gen, const std::string &xmlPath) {
-        parse = std::make_unique<Parse>();
-
         if (isLoaded()) {
             unload();
         }
@@ -1308,6 +1515,17 @@ namespace vkgen
             unload();
             return false;
         }
+        return loadFromXML(gen, xmlPath);
+    }
+
+    bool Registry::loadFromXML(Generator &gen, const std::string &xmlPath) {
+        Trace::Scope trace{ [&] { return "parse " + std::filesystem::path(xmlPath).filename().string(); } };
+        auto start = std::chrono::system_clock::now();
+
+        parse = std::make_unique<Parse>();
+        if (!GenerationCache::directory.empty()) {
+            xmlHash = GenerationCache::hashFile(xmlPath);
+        }
 
         parseXML(gen);
         buildTypesMap();
@@ -1325,46 +1543,34 @@ namespace vkgen
             auto &inc = it->second;
             const auto &name = r.second;
 
-            for (const auto &s : structs) {
-                for (const auto &m : s.members) {
-                    if (m->original.type() == name) {
-                        auto *platform = s.getPlatfrom();
-                        if (platform) {
-                            platform->includes.insert(inc);
-                        }
-                        else {
-                            auto *ext = s.getExtension();
-                            if (!ext) {
-                                std::cerr << "found: " << name << " -> " << req << "\n";
-                            }
-                            else {
-                                // std::cout << "found: " << name << " -> " << req << " -> " << ext->name << "\n";
-                                bool dup = false;
-                                for (const auto &i : ext->includes) {
-                                    if (i.get() == inc) {
-                                        dup = true;
-                                        break;
-                                    }
-                                }
-                                if (!dup) {
-                                    ext->includes.emplace_back(std::ref(inc));
-                                }
-                            }
-                        }
-
-                        break;
+            for (auto *user : getTypeUsers(name)) {
+                auto *platform = user->getPlatfrom();
+                if (user->metaType() == MetaType::Command) {
+                    if (platform) {
+                        platform->includes.insert(inc);
                     }
+                    continue;
                 }
-            }
-            for (const auto &c : commands) {
-                for (const auto &p : c._params) {
-                    auto *platform = c.getPlatfrom();
-                    if (!platform) {
-                        continue;
+                if (platform) {
+                    platform->includes.insert(inc);
+                }
+                else {
+                    auto *ext = user->getExtension();
+                    if (!ext) {
+                        std::cerr << "found: " << name << " -> " << req << "\n";
                     }
-                    if (p->original.type() == name) {
-                        platform->includes.insert(inc);
-                        break;
+                    else {
+                        // std::cout << "found: " << name << " -> " << req << " -> " << ext->name << "\n";
+                        bool dup = false;
+                        for (const auto &i : ext->includes) {
+                            if (i.get() == inc) {
+                                dup = true;
+                                break;
+                            }
+                        }
+                        if (!dup) {
+                            ext->includes.emplace_back(std::ref(inc));
+                        }
                     }
                 }
             }
@@ -1594,6 +1800,11 @@ namespace vkgen
 
         parse = nullptr;
         registryPath = xmlPath;
+        // registry data does not point into document, release it
+        doc.Clear();
+        root   = nullptr;
+        loaded = true;
+        loadTime += std::chrono::system_clock::now() - start;
         loadFinished();
         return true;
     }
@@ -1613,8 +1824,14 @@ namespace vkgen
     }
 
     void Registry::unload() {
+        doc.Clear();
         root         = nullptr;
+        loaded       = false;
         registryPath = "";
+        loadTime     = {};
+        typeUsers.clear();
+        flagBitsToFlags.clear();
+        flagsToFlagBits.clear();
 
         baseTypes.clear();
         apiConstants.clear();
@@ -1631,6 +1848,67 @@ namespace vkgen
 
     }
 
+    void Registry::benchmarkLookup(size_t rounds) const {
+        std::vector<std::string>                   names;
+        std::map<std::string, size_t, std::less<>> baseline;
+        NameIndex                                  index;
+
+        const auto collect = [&](const auto &container) {
+            for (const auto &item : container.items) {
+                names.emplace_back(item.name.original);
+                names.emplace_back(item.name);
+            }
+        };
+        collect(structs);
+        collect(enums);
+        collect(handles);
+        collect(commands);
+        for (size_t i = 0; i < names.size(); ++i) {
+            baseline.emplace(names[i], i);
+            index.emplace(names[i], i);
+        }
+
+        size_t found = 0;
+        const auto measure = [&](const std::string &label, auto &&lookup) {
+            found = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                for (const auto &n : names) {
+                    found += lookup(std::string_view{ n });
+                }
+            }
+            auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+            const auto count = static_cast<double>(names.size() * rounds);
+            std::cout << vkgen::format("  {:<10} {:8.2f} ns/lookup, {:8.2f} M lookups/s ({} found)\n",
+                                       label, elapsed.count() / count, count / elapsed.count() * 1000.0, found);
+        };
+
+        std::cout << "lookup benchmark: " << names.size() << " names, " << rounds << " rounds\n";
+        measure("std::map", [&](std::string_view name) -> size_t {
+            // previous Container behaviour, key converted to std::string
+            return baseline.find(std::string{ name }) != baseline.end();
+        });
+        measure("NameIndex", [&](std::string_view name) -> size_t {
+            return index.find(name) != nullptr;
+        });
+
+        names.clear();
+        for (const auto &e : enums) {
+            if (e.isBitmask()) {
+                names.emplace_back(e.bitmask.original);
+                names.emplace_back(e.bitmask);
+            }
+        }
+        std::cout << "FlagBits -> Flags: " << names.size() << " names, " << rounds << " rounds\n";
+        measure("std::regex", [&](std::string_view name) -> size_t {
+            // previous conversion, regex constructed for every call
+            return std::regex_replace(std::string{ name }, std::regex("FlagBits"), "Flags").size();
+        });
+        measure("flags map", [&](std::string_view name) -> size_t {
+            return toFlagsName(std::string{ name }).size();
+        });
+    }
+
     std::string Registry::to_string(vkr::Command::PFNReturnCategory value) {
         using enum vkr::Command::PFNReturnCategory;
         switch (value) {
@@ -1658,10 +1936,14 @@ namespace vkgen
     }
 
     bool Registry::loadXML(const std::string &xmlPath) {
-        std::cout << "load: " << xmlPath << "\n";
+        // may run concurrently with other registries, print whole lines only
+        std::cout << ("load: " + xmlPath + "\n");
+        Trace::Scope trace{ [&] { return "loadXML " + std::filesystem::path(xmlPath).filename().string(); } };
+        auto start = std::chrono::system_clock::now();
         const auto err = doc.LoadFile(xmlPath.c_str());
+        loadTime = std::chrono::system_clock::now() - start;
         if (err != tinyxml2::XML_SUCCESS) {
-            std::cerr << "XML load failed: " << std::to_string(err) << " (file: " << xmlPath + ")\n";
+            std::cerr << ("XML load failed: " + std::to_string(err) + " (file: " + xmlPath + ")\n");
             return false;
         }
 
@@ -1674,6 +1956,8 @@ namespace vkgen
     }
 
     void Registry::parseXML(Generator &gen) {
+        Trace::Scope trace{ "parseXML" };
+
         using Func    = void (vkgen::Registry::*)(Generator &, xml::Element, xml::Element);
         using Binding = std::pair<const std::string_view, Func>;
         // specifies order of parsing vk.xml registry
@@ -1724,16 +2008,35 @@ namespace vkgen
     bool VulkanRegistry::load(Generator &gen, const std::string &xmlPath) {
         unload();
 
-        {
-            std::filesystem::path path = xmlPath;
-            path                       = path.replace_filename("video.xml");
-            if (std::filesystem::exists(path)) {
-                video = std::make_unique<VideoRegistry>();
-                video->load(gen, path.string());
+        std::filesystem::path videoPath = xmlPath;
+        videoPath.replace_filename("video.xml");
+        if (std::filesystem::exists(videoPath)) {
+            video = std::make_unique<VideoRegistry>();
+        }
+
+        // documents are independent until parsing, load video.xml on separate thread
+        std::future<bool> videoResult;
+        if (video) {
+            videoResult = std::async(std::launch::async, [&] {
+                return video->loadXML(videoPath.string());
+            });
+        }
+        const bool xmlResult = loadXML(xmlPath);
+
+        if (video) {
+            // parsing video registry resolves names through gen, so it stays serial
+            if (videoResult.get()) {
+                video->loadFromXML(gen, videoPath.string());
+            } else {
+                video->unload();
             }
         }
 
-        auto result = Registry::load(gen, xmlPath);
+        if (!xmlResult) {
+            Registry::unload();
+            return false;
+        }
+        auto result = loadFromXML(gen, xmlPath);
         if (!result) {
             return false;
         }
@@ -1976,11 +2279,11 @@ namespace vkgen::vkr
     }
 
     std::string Enum::toFlags(const std::string &name) {
-        return std::regex_replace(name, std::regex("FlagBits"), "Flags");
+        return strReplaceAll(name, "FlagBits", "Flags");
     }
 
     std::string Enum::toFlagBits(const std::string &name) {
-        return std::regex_replace(name, std::regex("Flags"), "FlagBits");
+        return strReplaceAll(name, "Flags", "FlagBits");
     }
 
     EnumValue::EnumValue(const Registry &reg, std::string name, const std::string &value, const std::string &enumName, bool isBitmask)
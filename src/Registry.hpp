@@ -18,15 +18,19 @@
 #ifndef GENERATOR_REGISTRY_HPP
 #define GENERATOR_REGISTRY_HPP
 
+#include "SymbolTable.hpp"
 #include "Utils.hpp"
 #include "Variable.hpp"
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -238,6 +242,11 @@ namespace vkgen
             aliases.emplace_back(*this, std::string{ alias }, firstCapital);
         }
 
+        // sets state without subscribing dependencies, used by Registry::setEnabledBatch
+        void setEnabledState(bool value) {
+            enabled = value && supported;
+        }
+
         void setEnabled(bool value) {
             if (enabled == value || !supported) {
                 return;
@@ -732,6 +741,35 @@ namespace vkgen
 
             // private:
             bool prepared = false;
+
+            // taken through CommandLock, commands are shared by handles emitted on different threads
+            std::unique_ptr<std::recursive_mutex> mutex     = std::make_unique<std::recursive_mutex>();
+            int                                   lockDepth = 0;
+        };
+
+        // Member generators and resolvers rewrite params of the command in place, so a command
+        // is used by one thread at a time. The outermost lock restores params on release,
+        // every holder then starts from the same state whichever handle used the command before.
+        class CommandLock
+        {
+            Command &cmd;
+
+          public:
+            explicit CommandLock(Command &cmd) : cmd(cmd) {
+                cmd.mutex->lock();
+                cmd.lockDepth++;
+            }
+
+            CommandLock(const CommandLock &) = delete;
+
+            CommandLock &operator=(const CommandLock &) = delete;
+
+            ~CommandLock() {
+                if (--cmd.lockDepth == 0) {
+                    cmd.prepare();
+                }
+                cmd.mutex->unlock();
+            }
         };
 
         struct Feature : public GenericType {
@@ -804,6 +842,7 @@ namespace vkgen
             struct Platform             *platform;
             std::string                  protect;
             unsigned int                 number = 0;
+            bool                         device = {};  // type="device", otherwise instance extension
             std::vector<vkr::Extension*> depends;
             std::string                  versiondepends;
             std::string                  comment;
@@ -968,6 +1007,104 @@ namespace vkgen
         }
     };
 
+    // open addressing hash index of names, lookup by string_view does not allocate
+    class NameIndex
+    {
+        static constexpr uint32_t emptySlot = 0;
+
+        std::vector<std::string> keys;
+        std::vector<size_t>      hashes;
+        std::vector<size_t>      values;
+        std::vector<uint32_t>    slots;  // index into keys + 1, 0 means empty
+
+        static size_t hash(const std::string_view key) noexcept {
+            return std::hash<std::string_view>{}(key);
+        }
+
+        void rehash(size_t capacity) {
+            slots.assign(capacity, emptySlot);
+            const size_t mask = capacity - 1;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                size_t pos = hashes[i] & mask;
+                while (slots[pos] != emptySlot) {
+                    pos = (pos + 1) & mask;
+                }
+                slots[pos] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+      public:
+        void reserve(size_t count) {
+            keys.reserve(count);
+            hashes.reserve(count);
+            values.reserve(count);
+            size_t capacity = 16;
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+            if (capacity > slots.size()) {
+                rehash(capacity);
+            }
+        }
+
+        // does not replace existing key, same as std::map::emplace
+        bool emplace(const std::string_view key, size_t value) {
+            if ((keys.size() + 1) * 2 > slots.size()) {
+                rehash(std::max<size_t>(16, slots.size() * 2));
+            }
+            const size_t h    = hash(key);
+            const size_t mask = slots.size() - 1;
+            size_t       pos  = h & mask;
+            while (slots[pos] != emptySlot) {
+                const size_t i = slots[pos] - 1;
+                if (hashes[i] == h && keys[i] == key) {
+                    return false;
+                }
+                pos = (pos + 1) & mask;
+            }
+            slots[pos] = static_cast<uint32_t>(keys.size() + 1);
+            keys.emplace_back(key);
+            hashes.push_back(h);
+            values.push_back(value);
+            return true;
+        }
+
+        const size_t *find(const std::string_view key) const noexcept {
+            if (slots.empty()) {
+                return nullptr;
+            }
+            const size_t h    = hash(key);
+            const size_t mask = slots.size() - 1;
+            size_t       pos  = h & mask;
+            while (slots[pos] != emptySlot) {
+                const size_t i = slots[pos] - 1;
+                if (hashes[i] == h && keys[i] == key) {
+                    return &values[i];
+                }
+                pos = (pos + 1) & mask;
+            }
+            return nullptr;
+        }
+
+        template <typename F>
+        void foreach (F &&func) const {
+            for (size_t i = 0; i < keys.size(); ++i) {
+                func(keys[i], values[i]);
+            }
+        }
+
+        size_t size() const {
+            return keys.size();
+        }
+
+        void clear() {
+            keys.clear();
+            hashes.clear();
+            values.clear();
+            slots.clear();
+        }
+    };
+
     class Registry
     {
       public:
@@ -990,7 +1127,7 @@ namespace vkgen
         {
             static_assert(std::is_base_of<GenericType, T>::value, "T must derive from BaseType");
 
-            std::map<std::string, size_t, std::less<>> map;
+            NameIndex map;
             std::map<std::string, GenericType*> aliasMap;
 
           public:
@@ -1010,6 +1147,7 @@ namespace vkgen
 
                 ordered.clear();
                 ordered.reserve(items.size());
+                map.reserve(items.size() * 2);
                 for (size_t i = 0; i < items.size(); ++i) {
                     map.emplace(items[i].name.original, i);
                     map.emplace(items[i].name, i);
@@ -1028,45 +1166,45 @@ namespace vkgen
             }
 
             void addTypes(Registry::Types &types) {
-                for (const auto &k : map) {
-                    types.emplace(k.first, &items[k.second]);
-                }
+                map.foreach([&](const std::string &key, size_t index) {
+                    types.emplace(key, &items[index]);
+                });
             }
 
             const_iterator find(const std::string_view name, bool dbg = false) const {
-                auto it = map.find(std::string{ name });
-                if (it == map.end()) {
+                const auto *index = map.find(name);
+                if (!index) {
                     if (dbg)
                         std::cerr << ". " << std::string{ name } << " not found in Container<" << std::string{ typeid(T).name() } << ">\n";
                     return items.end();
                 }
-                return items.begin() + it->second;
+                return items.begin() + *index;
             }
 
             iterator find(const std::string_view name, bool dbg = false) {
-                auto it = map.find(std::string{ name });
-                if (it == map.end()) {
+                const auto *index = map.find(name);
+                if (!index) {
                     if (dbg)
                         std::cerr << ". " << std::string{ name } << " not found in Container<" << std::string{ typeid(T).name() } << ">\n";
                     return items.end();
                 }
-                return items.begin() + it->second;
+                return items.begin() + *index;
             }
 
             T &operator[](const std::string_view name) {
-                auto it = map.find(name);
-                if (it == map.end()) {
+                const auto *index = map.find(name);
+                if (!index) {
                     throw std::runtime_error(std::string{ name } + " not found in Container<" + std::string{ typeid(T).name() } + ">");
                 }
-                return items[it->second];
+                return items[*index];
             }
 
             const T &operator[](const std::string_view name) const {
-                auto it = map.find(name);
-                if (it == map.end()) {
+                const auto *index = map.find(name);
+                if (!index) {
                     throw std::runtime_error(std::string{ name } + " not found in Container<" + std::string{ typeid(T).name() } + ">");
                 }
-                return items[it->second];
+                return items[*index];
             }
 
             iterator end() {
@@ -1129,6 +1267,8 @@ namespace vkgen
                 std::vector<Item *>   children;
                 std::vector<Item *>   deps;
                 std::set<std::string> plats;
+                size_t                index    = {};
+                size_t                pass     = {};
                 bool                  inserted = {};
 
                 void addDependency(DependencySorter<T> &sorter, const std::string &dep) {
@@ -1136,16 +1276,13 @@ namespace vkgen
                     if (!item) {
                         return;
                     }
-                    bool unique = true;
                     for (const auto &d : deps) {
-                        if (d->data->name.original == dep) {
-                            unique = false;
-                            break;
+                        if (d == item) {
+                            item->add(this);
+                            return;
                         }
                     }
-                    if (unique) {
-                        deps.push_back(item);
-                    }
+                    deps.push_back(item);
                     item->add(this);
                 }
 
@@ -1175,10 +1312,9 @@ namespace vkgen
                 source.ordered.clear();
                 source.ordered.reserve(source.size());
 
-                items.clear();
-                items.reserve(source.size());
+                init(source.size());
                 for (auto &i : source.items) {
-                    items.emplace_back(&i);
+                    addItem(&i);
                 }
 
                 sortItems(source.ordered, msg, getDependencies);
@@ -1187,10 +1323,9 @@ namespace vkgen
             void sort(std::vector<std::reference_wrapper<T>> &source, const std::string &msg) {
 
                 auto size = source.size();
-                items.clear();
-                items.reserve(size);
+                init(size);
                 for (T &i : source) {
-                    items.emplace_back(&i);
+                    addItem(&i);
                 }
 
                 source.clear();
@@ -1208,51 +1343,113 @@ namespace vkgen
 
           private:
 
+            void init(size_t size) {
+                items.clear();
+                items.reserve(size);
+                index.clear();
+                index.reserve(size);
+            }
+
+            void addItem(T *data) {
+                auto &item = items.emplace_back();
+                item.data  = data;
+                item.index = items.size() - 1;
+                index.emplace(data->name.original, item.index);
+            }
+
+            // Kahn's algorithm. Output order matches repeated sweeps over source order:
+            // item is placed in the first sweep where all of its dependencies precede it,
+            // that is pass(i) = max(pass(d) + (d after i)), ties are broken by source order.
             void sortItems(std::vector<std::reference_wrapper<T>> &dst, const std::string &msg, std::function<void(Item &i)> getDependencies) {
 
                 for (auto &i : items) {
                     getDependencies(i);
                 }
 
-                bool empty = false;
-                while (!empty) {
-                    empty      = true;
-                    bool stuck = true;
-                    for (auto &i : items) {
-                        if (!i.inserted) {
-                            if (i.hasDepsInserted()) {
-                                dst.push_back(std::ref(*i.data));
-                                i.inserted = true;
-                                stuck      = false;
-                            }
-                            empty = false;
-                        }
+                std::vector<size_t> pending(items.size());
+                std::vector<Item *> queue;
+                queue.reserve(items.size());
+                for (auto &i : items) {
+                    pending[i.index] = i.deps.size();
+                    if (i.deps.empty()) {
+                        queue.push_back(&i);
                     }
-                    if (!empty && stuck) {
-                        std::cerr << "dependcy sort: infinite loop detected" << std::endl;
-                        for (auto &i : items) {
-                            if (!i.inserted) {
-                                std::cout << i.data->name << "\n";
-                                for (auto &d : i.deps) {
-                                    std::cout << "  " << d->data->name;
-                                }
-                                std::cout << "\n";
-                            }
+                }
+
+                for (size_t q = 0; q < queue.size(); ++q) {
+                    Item *item     = queue[q];
+                    item->inserted = true;
+                    for (Item *c : item->children) {
+                        c->pass = std::max(c->pass, item->pass + (item->index > c->index ? 1 : 0));
+                        if (--pending[c->index] == 0) {
+                            queue.push_back(c);
                         }
+                    }
+                }
+
+                std::stable_sort(queue.begin(), queue.end(), [](const Item *a, const Item *b) {
+                    if (a->pass != b->pass) {
+                        return a->pass < b->pass;
+                    }
+                    return a->index < b->index;
+                });
+                for (const Item *i : queue) {
+                    dst.push_back(std::ref(*i->data));
+                }
+
+                if (queue.size() != items.size()) {
+                    reportCycle(msg);
+                }
+            }
+
+            void reportCycle(const std::string &msg) const {
+                // every item left has at least one dependency that was not inserted, following them must loop
+                const Item *item = nullptr;
+                for (const auto &i : items) {
+                    if (!i.inserted) {
+                        item = &i;
                         break;
                     }
                 }
+
+                std::vector<const Item *> path;
+                std::vector<size_t>       visited(items.size(), 0);
+                while (item && !visited[item->index]) {
+                    visited[item->index] = path.size() + 1;
+                    path.push_back(item);
+                    const Item *next = nullptr;
+                    for (const auto *d : item->deps) {
+                        if (!d->inserted) {
+                            next = d;
+                            break;
+                        }
+                    }
+                    item = next;
+                }
+
+                std::string cycle;
+                if (item) {
+                    for (size_t i = visited[item->index] - 1; i < path.size(); ++i) {
+                        cycle += path[i]->data->name.original + " -> ";
+                    }
+                    cycle += item->data->name.original;
+                }
+                size_t unsorted = 0;
+                for (const auto &i : items) {
+                    unsorted += !i.inserted;
+                }
+                std::cerr << "dependency sort (" << msg << "): cycle detected: " << cycle << " (" << unsorted << " items not sorted)" << std::endl;
             }
 
-            std::vector<Item> items;
+            std::vector<Item>                             items;
+            std::unordered_map<std::string_view, size_t> index;
 
             Item *find(const std::string &name) {
-                for (auto &i : items) {
-                    if (i.data->name.original == name) {
-                        return &i;
-                    }
+                auto it = index.find(name);
+                if (it == index.end()) {
+                    return nullptr;
                 }
-                return nullptr;
+                return &items[it->second];
             };
         };
 
@@ -1301,6 +1498,12 @@ namespace vkgen
         bool defaultWhitelistOption = true;
         bool verbose                = false;
 
+        std::chrono::duration<double> loadTime = {};
+
+        bool loadXML(const std::string &xmlPath);
+
+        bool loadFromXML(Generator &gen, const std::string &xmlPath);
+
       public:
         std::string registryPath;
 
@@ -1324,6 +1527,11 @@ namespace vkgen
         std::unordered_map<std::string, vkr::BaseType>      baseTypes;
         std::unordered_map<std::string, vkr::FuncPointer>   funcPointers;
         std::unordered_map<std::string, std::reference_wrapper<GenericType>>    aliases;
+        // bidirectional Flags <-> FlagBits names of bitmask enums, both original and converted names
+        std::unordered_map<std::string, std::string>                         flagBitsToFlags;
+        std::unordered_map<std::string, std::string>                         flagsToFlagBits;
+        // type name -> structs and commands that use it as member or parameter
+        std::unordered_map<std::string, std::vector<GenericType *>>            typeUsers;
 
         std::string strRemoveTag(std::string &str) const;
 
@@ -1356,8 +1564,10 @@ namespace vkgen
         String& getHandleSuperclass(const Handle &data);
 
       private:
-        tinyxml2::XMLDocument doc;
+        tinyxml2::XMLDocument doc;  // only alive during load
         tinyxml2::XMLElement *root = {};
+        bool                  loaded = false;
+        uint64_t              xmlHash = {};
 
         std::function<void(void)> onLoadCallback;
 
@@ -1388,8 +1598,6 @@ namespace vkgen
 
         void loadFinished();
 
-        bool loadXML(const std::string &xmlPath);
-
         void parseXML(Generator &gen);
 
         void removeUnsupportedFeatures();
@@ -1407,6 +1615,12 @@ namespace vkgen
 
         GenericType *find(const std::string &name) noexcept;
 
+        const std::vector<GenericType *> &getTypeUsers(const std::string &type) const;
+
+        std::string toFlagsName(const std::string &name) const;
+
+        std::string toFlagBitsName(const std::string &name) const;
+
         GenericType *find(const std::string_view name) noexcept {
             return find(std::string{ name });
         }
@@ -1418,6 +1632,24 @@ namespace vkgen
             return nullptr;
         }
 
+        // enables roots and their dependency closure in one pass, all other types are disabled.
+        // Result does not depend on order of roots, unlike chain of setEnabled calls
+        void setEnabledBatch(const std::vector<GenericType *> &roots);
+
+        struct TypeState
+        {
+            GenericType            *type    = {};
+            bool                    enabled = {};
+            std::set<GenericType *> subscribers;
+            // struct members, generation changes their special type depending on config
+            std::vector<std::pair<VariableData *, VariableData::Type>> members;
+        };
+
+        // enabled state and subscribers of every type reachable from containers, special types of struct members
+        std::vector<TypeState> saveTypeStates();
+
+        void restoreTypeStates(const std::vector<TypeState> &states);
+
         void orderStructs();
 
         void orderHandles();
@@ -1439,22 +1671,35 @@ namespace vkgen
         static std::string getDefaultRegistryPath();
 
         bool isLoaded() const {
-            return root != nullptr;
+            return loaded;
         }
 
         std::string getRegistryPath() const {
             return registryPath;
         }
 
+        double getLoadTime() const {
+            return loadTime.count();
+        }
+
+        // content hash of the loaded xml, only computed when the generation cache is enabled
+        uint64_t getXmlHash() const {
+            return xmlHash;
+        }
+
         bool load(Generator &gen, const std::string &xmlPath);
 
         void unload();
 
         void bindGUI(const std::function<void(void)> &onLoad);
+
+        // compares lookup throughput of Container index and flags name map with previous implementation
+        void benchmarkLookup(size_t rounds = 100) const;
     };
 
     class VideoRegistry : public Registry {
 
+        friend class VulkanRegistry;
 
     };
 
@@ -0,0 +1,120 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_SYMBOLTABLE_HPP
+#define GENERATOR_SYMBOLTABLE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vkgen
+{
+
+    // Interned strings stored in append only arena, views and ids stay valid for lifetime of the table.
+    // The global table is never cleared, keep it to small sets that repeat across reloads
+    // (platform protect macros, feature versions); registry names are owned by their containers.
+    class SymbolTable
+    {
+        static constexpr size_t blockSize = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>>             blocks;
+        size_t                                           used = blockSize;
+        std::vector<std::string_view>                    symbols;
+        std::unordered_map<std::string_view, uint32_t>   ids;
+        size_t                                           arenaBytes = {};
+        mutable std::mutex                               mutex;
+
+        // symbols are stored null terminated
+        std::string_view store(std::string_view str) {
+            if (str.size() + 1 > blockSize / 4) {
+                // large strings get own block, current block stays open for small ones
+                auto block = std::make_unique<char[]>(str.size() + 1);
+                std::memcpy(block.get(), str.data(), str.size());
+                block[str.size()] = '\0';
+                arenaBytes += str.size() + 1;
+                const char *data = block.get();
+                blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, std::move(block));
+                return { data, str.size() };
+            }
+            if (used + str.size() + 1 > blockSize) {
+                blocks.emplace_back(std::make_unique<char[]>(blockSize));
+                arenaBytes += blockSize;
+                used = 0;
+            }
+            char *dst = blocks.back().get() + used;
+            std::memcpy(dst, str.data(), str.size());
+            dst[str.size()] = '\0';
+            used += str.size() + 1;
+            return { dst, str.size() };
+        }
+
+      public:
+        using Id = uint32_t;
+
+        static SymbolTable &global() {
+            static SymbolTable table;
+            return table;
+        }
+
+        Id intern(std::string_view str) {
+            std::lock_guard lock(mutex);
+            auto it = ids.find(str);
+            if (it != ids.end()) {
+                return it->second;
+            }
+            const auto view = store(str);
+            const auto id   = static_cast<Id>(symbols.size());
+            symbols.push_back(view);
+            ids.emplace(view, id);
+            return id;
+        }
+
+        std::string_view view(std::string_view str) {
+            const auto id = intern(str);
+            std::lock_guard lock(mutex);
+            return symbols[id];
+        }
+
+        const char *c_str(std::string_view str) {
+            return view(str).data();
+        }
+
+        std::string_view operator[](Id id) const {
+            std::lock_guard lock(mutex);
+            return symbols[id];
+        }
+
+        size_t size() const {
+            std::lock_guard lock(mutex);
+            return symbols.size();
+        }
+
+        size_t memoryUsage() const {
+            std::lock_guard lock(mutex);
+            return arenaBytes + symbols.capacity() * sizeof(std::string_view) + ids.size() * (sizeof(std::string_view) + sizeof(Id) + 2 * sizeof(void *));
+        }
+    };
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_SYMBOLTABLE_HPP
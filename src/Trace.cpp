@@ -0,0 +1,103 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Trace.hpp"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace vkgen
+{
+
+    static std::string escapeJson(const std::string &str) {
+        std::string out;
+        out.reserve(str.size());
+        for (char c : str) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20) {
+                        out += c;
+                    }
+            }
+        }
+        return out;
+    }
+
+    void Trace::enable(const std::string &filename) {
+        std::lock_guard lock(mutex);
+        path    = filename;
+        origin  = std::chrono::steady_clock::now();
+        enabled = true;
+        events.clear();
+    }
+
+    void Trace::add(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+
+        const auto thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+
+        std::lock_guard lock(mutex);
+        events.push_back(Event{ std::move(name), duration_cast<microseconds>(start - origin).count(), duration_cast<microseconds>(end - start).count(), thread });
+    }
+
+    void Trace::save() {
+        std::lock_guard lock(mutex);
+        if (!enabled) {
+            return;
+        }
+
+        std::ofstream out(path, std::ios::out | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Can't open trace file: " << path << '\n';
+            return;
+        }
+
+        // map thread hashes to small ids
+        std::vector<size_t> threads;
+        const auto getThread = [&](size_t hash) {
+            for (size_t i = 0; i < threads.size(); ++i) {
+                if (threads[i] == hash) {
+                    return i + 1;
+                }
+            }
+            threads.push_back(hash);
+            return threads.size();
+        };
+
+        out << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < events.size(); ++i) {
+            const auto &e = events[i];
+            out << "{\"name\":\"" << escapeJson(e.name) << "\",\"cat\":\"vkgen\",\"ph\":\"X\",\"ts\":" << e.start << ",\"dur\":" << e.duration
+                << ",\"pid\":1,\"tid\":" << getThread(e.thread) << "}";
+            if (i + 1 != events.size()) {
+                out << ',';
+            }
+            out << '\n';
+        }
+        out << "],\"displayTimeUnit\":\"ms\"}\n";
+
+        std::cout << "trace: " << path << " (" << events.size() << " events)\n";
+    }
+
+}  // namespace vkgen
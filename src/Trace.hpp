@@ -0,0 +1,98 @@
+// MIT License
+// Copyright (c) 2021-2023  @guritchi
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GENERATOR_TRACE_HPP
+#define GENERATOR_TRACE_HPP
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace vkgen
+{
+
+    // Collects timed spans and writes them as Chrome trace event JSON (chrome://tracing, Perfetto)
+    class Trace
+    {
+        struct Event
+        {
+            std::string name;
+            int64_t     start    = {};
+            int64_t     duration = {};
+            size_t      thread   = {};
+        };
+
+        static inline std::string                                 path;
+        static inline std::vector<Event>                          events;
+        static inline std::mutex                                  mutex;
+        static inline std::chrono::steady_clock::time_point       origin;
+        static inline bool                                        enabled = false;
+
+      public:
+        class Scope
+        {
+            std::string                           name;
+            std::chrono::steady_clock::time_point start;
+
+          public:
+            explicit Scope(std::string_view name) {
+                if (enabled) {
+                    this->name = name;
+                    start      = std::chrono::steady_clock::now();
+                }
+            }
+
+            // composed names are built only when tracing is enabled
+            template <typename F>
+                requires std::is_invocable_r_v<std::string, F>
+            explicit Scope(F &&makeName) {
+                if (enabled) {
+                    name  = makeName();
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+            ~Scope() {
+                if (enabled) {
+                    Trace::add(std::move(name), start, std::chrono::steady_clock::now());
+                }
+            }
+        };
+
+        static void enable(const std::string &filename);
+
+        static bool isEnabled() {
+            return enabled;
+        }
+
+        static void add(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+        // writes collected events to file given to enable()
+        static void save();
+    };
+
+}  // namespace vkgen
+
+#endif  // GENERATOR_TRACE_HPP
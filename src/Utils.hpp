@@ -410,6 +410,35 @@ namespace vkgen
         }
     }
 
+    static std::string strTrim(const std::string_view &str) {
+        const auto first = str.find_first_not_of(" \t\r\n\f\v");
+        if (first == std::string_view::npos) {
+            return "";
+        }
+        const auto last = str.find_last_not_of(" \t\r\n\f\v");
+        return std::string{ str.substr(first, last - first + 1) };
+    }
+
+    static constexpr uint64_t fnv1aBasis = 0xcbf29ce484222325ull;
+
+    // FNV-1a, pass the previous result as hash to continue over multiple pieces
+    static uint64_t hashFnv1a(const std::string_view &data, uint64_t hash = fnv1aBasis) {
+        for (const char c : data) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    static std::string strReplaceAll(std::string str, const std::string_view &from, const std::string_view &to) {
+        size_t pos = 0;
+        while ((pos = str.find(from, pos)) != std::string::npos) {
+            str.replace(pos, from.size(), to);
+            pos += to.size();
+        }
+        return str;
+    }
+
     static void strStripVk(std::string &str) {
         strStripPrefix(str, "Vk");
         strStripPrefix(str, "vk");
@@ -454,7 +454,7 @@ std::string vkgen::VariableData::fullType(const Generator &gen, bool forceNamesp
     // type += "/*" + std::to_string((int)ns) + "*/";
     if (gen.getConfig().gen.enumMock == 1 && !fields[TYPE].starts_with("Vk")) {
 
-        type += std::regex_replace(fields[TYPE], std::regex("FlagBits"), "Flags");
+        type += gen.toFlagsName(fields[TYPE]);
     }
     else {
         type += fields[TYPE];
@@ -17,21 +17,36 @@
 // SOFTWARE.
 
 #include "ArgumentsParser.hpp"
+#include "FileWatcher.hpp"
 #include "Generator.hpp"
 #include "Registry.hpp"
+#include "Trace.hpp"
 
 #ifdef GENERATOR_GUI
 #    include "Gui.hpp"
 #endif
 
+#include <charconv>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 
 static constexpr char const *HELP_TEXT{
     R"(Usage:
     -r, --reg       path to source registry file    
     -d, --dest      path to destination directory
-    -c, --config    path to configuration file)"
+    -c, --config    path to configuration file
+                    repeat --config/--dest pairs to generate several configurations from one registry load
+    --cache         directory for generation cache
+    --stats         print output buffer and member allocation statistics
+    --trace         write Chrome trace event file with phase timings
+    --jobs          threads for enum, struct and handle class generation (0 = all cores)
+    --verify-jobs   check parallel output against serial generation
+    --verify-batch  check each --config/--dest pair of a batch against a separate run
+    --watch         keep running and regenerate when the config files or vk.xml change)"
 };
 
 static bool loadDefaultRegistry(vkgen::Generator &gen, bool quiet = false) {
@@ -45,6 +60,53 @@ static bool loadDefaultRegistry(vkgen::Generator &gen, bool quiet = false) {
     return gen.load(path);
 }
 
+static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream     in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// generates one config with a freshly loaded registry and compares every file with the batch output in dest
+static bool verifyBatchOutput(const std::string &registry, const std::string &config, const std::filesystem::path &dest, bool debugTags) {
+    using namespace vkgen;
+
+    const auto tmp = std::filesystem::temp_directory_path() / "vkgen-verify-batch";
+    std::filesystem::remove_all(tmp);
+    std::filesystem::create_directories(tmp);
+
+    // caches would replay blocks produced by the batch run
+    const auto cacheDirectory = GenerationCache::directory;
+    GenerationCache::directory.clear();
+
+    auto fresh = std::make_unique<Generator>();
+    if (!fresh->load(registry)) {
+        GenerationCache::directory = cacheDirectory;
+        throw std::runtime_error("Can't load registry.");
+    }
+    fresh->setOutputFilePath(tmp.string());
+    fresh->loadConfigFile(config);
+    if (debugTags) {
+        fresh->cfg.dbg.methodTags.data = true;
+    }
+    fresh->generate();
+    GenerationCache::directory = cacheDirectory;
+
+    bool same = true;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(tmp)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        const auto batchFile = dest / std::filesystem::relative(entry.path(), tmp);
+        if (readFile(entry.path()) != readFile(batchFile)) {
+            std::cerr << "verify-batch: " << batchFile.string() << " differs from separate run\n";
+            same = false;
+        }
+    }
+    std::filesystem::remove_all(tmp);
+    return same;
+}
+
 int main(int argc, char **argv) {
     using namespace vkgen;
 
@@ -60,6 +122,14 @@ int main(int argc, char **argv) {
         const auto &guifpsOption = p.add("", "--fps" );
         const auto &extensionOption = p.add("", "--ext" );
         const auto &dbgtagOption = p.add("", "--debug" );
+        const auto &cacheOption = p.add("", "--cache", true );
+        const auto &benchOption = p.add("", "--bench-lookup" );
+        const auto &statsOption = p.add("", "--stats" );
+        const auto &traceOption = p.add("", "--trace", true );
+        const auto &jobsOption = p.add("", "--jobs", true );
+        const auto &verifyJobsOption = p.add("", "--verify-jobs" );
+        const auto &verifyBatchOption = p.add("", "--verify-batch" );
+        const auto &watchOption = p.add("", "--watch" );
 #ifdef GENERATOR_TOOL
         const auto &toolOption = p.add("", "--tool" );
         const auto &analyzeOption = p.add("", "--analyze", true );
@@ -78,6 +148,13 @@ int main(int argc, char **argv) {
         }
 #endif
 
+        if (cacheOption.set) {
+            GenerationCache::directory = cacheOption.value;
+        }
+        if (traceOption.set) {
+            Trace::enable(traceOption.value);
+        }
+
         Generator gen;
 
         const auto loadRegistry = [&](bool quiet = false) {
@@ -99,21 +176,104 @@ int main(int argc, char **argv) {
             if (!destOption.set) {
                 throw std::runtime_error("Missing arguments. See usage.");
             }
+            const auto &configs = configOption.values;
+            const auto &dests   = destOption.values;
+            const bool  batch   = configs.size() > 1 || dests.size() > 1;
+            if (batch && configs.size() != dests.size()) {
+                throw std::runtime_error("Each --dest needs its own --config in batch mode. See usage.");
+            }
             if (!loadRegistry()) {
                 throw std::runtime_error("Can't load registry.");
             }
-            if (configOption.set) {
-                gen.loadConfigFile(configOption.value);
+            if (statsOption.set) {
+                gen.setPrintOutputStats(true);
+            }
+            // reset: registry was used by previous run
+            const auto run = [&](bool reset) {
+                for (size_t i = 0; i < dests.size(); ++i) {
+                    if (reset || i > 0) {
+                        gen.resetConfigState();
+                    }
+                    if (batch) {
+                        std::cout << "batch " << i + 1 << "/" << dests.size() << ": " << configs[i] << " -> " << dests[i] << '\n';
+                        gen.setOutputFilePath(dests[i]);
+                    }
+                    if (configOption.set) {
+                        gen.loadConfigFile(batch ? configs[i] : configOption.value);
+                    }
+                    if (dbgtagOption.set) {
+                        gen.cfg.dbg.methodTags.data = true;
+                    }
+                    gen.generate();
+                }
+            };
+            run(false);
+            if (verifyBatchOption.set && batch) {
+                bool same = true;
+                for (size_t i = 0; i < dests.size(); ++i) {
+                    same &= verifyBatchOutput(gen.getRegistryPath(), configs[i], dests[i], dbgtagOption.set);
+                }
+                if (!same) {
+                    throw std::runtime_error("Batch output differs from separate runs.");
+                }
+                std::cout << "verify-batch: output matches separate runs\n";
+            }
+            Trace::save();
+            if (!watchOption.set) {
+                return;
+            }
+
+            FileWatcher watcher;
+            const auto  registryPath = std::filesystem::absolute(gen.getRegistryPath()).lexically_normal();
+            const auto  videoPath    = std::filesystem::path(registryPath).replace_filename("video.xml");
+            watcher.add(registryPath);
+            if (std::filesystem::exists(videoPath)) {
+                watcher.add(videoPath);
+            }
+            for (const auto &c : configs) {
+                watcher.add(c);
             }
-            if (dbgtagOption.set) {
-                gen.cfg.dbg.methodTags.data = true;
+            std::cout << "watching for changes, press Ctrl+C to stop\n";
+            while (true) {
+                const auto changed  = watcher.wait();
+                bool       registry = false;
+                for (const auto &c : changed) {
+                    std::cout << "changed: " << c.string() << '\n';
+                    if (c == registryPath || c == videoPath) {
+                        registry = true;
+                    }
+                }
+                // a broken edit should not end the session, report and wait for the next one
+                try {
+                    if (registry || !gen.isLoaded()) {
+                        if (!gen.load(registryPath.string())) {
+                            throw std::runtime_error("Can't load registry.");
+                        }
+                    }
+                    run(!registry);
+                }
+                catch (const std::exception &e) {
+                    std::cerr << "Error: " << e.what() << std::endl;
+                }
             }
-            gen.generate();
         };
 
         if (destOption.set) {
             gen.setOutputFilePath(destOption.value);
         }
+        if (jobsOption.set) {
+            // from_chars rejects signs, so "-1" can't wrap around, and trailing characters are checked below
+            const auto &value = jobsOption.value;
+            size_t      jobs  = 0;
+            const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), jobs);
+            if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                throw std::runtime_error("Invalid --jobs value: " + value);
+            }
+            gen.setJobs(jobs);
+        }
+        if (verifyJobsOption.set) {
+            gen.setVerifyJobs(true);
+        }
         if (resaveOption.set) {
             if (!configOption.set) {
                 throw std::runtime_error("Missing arguments. See usage.");
@@ -126,6 +286,13 @@ int main(int argc, char **argv) {
         }
 
         Registry::loadRegistryPath();
+        if (benchOption.set) {
+            if (loadRegistry()) {
+                gen.benchmarkLookup();
+            }
+            return 0;
+        }
+
 #ifdef GENERATOR_TOOL
         if (analyzeOption.set) {
             if (!loadRegistry()) {